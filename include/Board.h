@@ -2,10 +2,20 @@
 #define BOARD_H
 
 #include "../src/Pieces/Piece.h"
+#include "NnueNetwork.h"
 #include <array>
 #include <vector>
 #include <string>
 #include <set>
+#include <cstdint>
+
+// What Board::givesCheck needs about one position, computed once per node for
+// the side about to move. Squares are bits x * 8 + y
+struct CheckInfo {
+    int kingSquare;            // Enemy king, -1 if there is none
+    uint64_t checkSquares[6];  // Squares where a piece of each type (P, N, B, R, Q, K) would give check
+    uint64_t discoverers;      // Own pieces shielding the king from one of our sliders
+};
 
 class Board {
 public:
@@ -15,6 +25,14 @@ public:
     Board& operator=(const Board& other); // Assignment operator
     
     void resetBoard();
+    
+    // Set up the position of a FEN record in one pass over the text. Returns false,
+    // leaving the board unchanged, unless the record is well formed and the position
+    // legal: one king a side, no pawn on the back ranks, the side not to move not in
+    // check, and an en passant square behind a pawn that just advanced two squares.
+    // Missing trailing fields default to "- - 0 1". Reports the side to move and the
+    // fullmove number
+    bool loadFEN(const std::string& fen, bool& whiteToMove, int& fullmoveNumber);
     void printBoard() const;
     Piece* getPiece(int x, int y) const;
     void movePiece(int x1, int y1, int x2, int y2);
@@ -29,6 +47,20 @@ public:
     std::pair<int, int> findKing(bool isWhiteKing) const;
     bool isSquareUnderAttack(int x, int y, bool byWhite) const;
     std::vector<std::pair<int, int>> getLegalMoves(int x, int y) const;
+    
+    // Legal moves of one side, appended to moves. Only squares the piece could
+    // reach are tested, and captures (en passant included) and quiet moves
+    // (castling included) can be generated separately so a search can stop
+    // before producing quiet moves it never needs
+    void generateMoves(bool forWhite, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const;
+    void generateCaptures(bool forWhite, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const;
+    void generateQuietMoves(bool forWhite, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const;
+    bool isCaptureMove(int x1, int y1, int x2, int y2) const; // Includes en passant
+    // Squares the piece on (x, y) could reach on an empty board, sliders cut short at
+    // the first blocker, in a fixed order; the legal moves are among them. Fills up
+    // to MAX_TARGETS entries and returns how many
+    int getCandidateTargets(int x, int y, std::pair<int, int>* targets) const;
+    static const int MAX_TARGETS = 28;
     bool isGameOver() const;
     std::string getGameStatus() const;
 
@@ -45,8 +77,51 @@ public:
     std::pair<int, int> getEnPassantTarget() const;
     void clearEnPassantTarget();
     
-    // AI evaluation
+    // AI evaluation: tapered piece-square score in centipawns, positive favours White.
+    // Kept up to date by every move, so this is O(1). With a network set, the
+    // network's incrementally updated accumulator is evaluated instead
     int evaluatePosition() const;
+    int getGamePhase() const { return gamePhase; } // 24 = all minor and major pieces, 0 = pawn ending
+    void setNetwork(const NnueNetwork* evaluator); // nullptr selects the piece-square tables
+    const NnueNetwork* getNetwork() const { return network; }
+    
+    // Pawn structure (passed, isolated, doubled, backward), computed from scratch;
+    // callers cache it by getPawnKey(), which only depends on the pawns
+    void evaluatePawnStructure(int& midgame, int& endgame) const;
+    uint64_t getPawnKey() const { return pawnKey; }
+    uint64_t getPieceKey() const { return pieceKey; } // Placement only, no side to move or rights
+    int taperScore(int midgame, int endgame) const; // Blend by the current game phase
+    
+    // Whether a legal move gives check, without making it. Castling, en passant
+    // and promotions, which move more than one piece, are played on a copy
+    CheckInfo getCheckInfo(bool forWhite) const;
+    bool givesCheck(int x1, int y1, int x2, int y2, const CheckInfo& info) const;
+    
+    // Static exchange evaluation: material the mover wins (centipawns, negative if it
+    // loses) when every capture on (x2, y2) is played least valuable attacker first
+    int staticExchange(int x1, int y1, int x2, int y2) const;
+    
+    // Position hashing (Polyglot key layout)
+    uint64_t getZobristKey(bool whiteToMove) const;
+    
+    // Draw bookkeeping: halfmoves since the last capture or pawn move, and the
+    // keys of the positions since then (current position last)
+    int getHalfmoveClock() const { return halfmoveClock; }
+    void setHalfmoveClock(int clock) { halfmoveClock = clock; }
+    bool isFiftyMoveDraw() const { return halfmoveClock >= 100; }
+    bool isRepetition() const;     // The current position occurred before
+    int countRepetitions() const;  // Occurrences of the current position, itself included
+    
+    // Standard Algebraic Notation (e.g. "Nbd7", "R1e2", "exd5", "e8=Q+", "O-O"), check and
+    // annotation suffixes ignored; {{-1,-1},{-1,-1}} if it is malformed, ambiguous or not
+    // a legal move. Under-promotions are rejected since pawns always promote to a queen
+    std::pair<std::pair<int, int>, std::pair<int, int>> parseSAN(const std::string& san, bool whiteToMove) const;
+    // Whether san promotes to a knight, bishop or rook ("e8=N", "bxa1R+"), which
+    // parseSAN cannot play; lets callers tell such moves from illegal ones
+    static bool isUnderPromotion(const std::string& san);
+    // SAN of a legal move, disambiguated only as far as needed, with "+" or "#" when it
+    // checks or mates
+    std::string toSAN(int x1, int y1, int x2, int y2) const;
 
 private:
     std::array<std::array<Piece*, 8>, 8> board;
@@ -59,8 +134,27 @@ private:
     // En Passant tracking
     std::pair<int, int> enPassantTarget; // Square where en passant is possible (-1, -1) if none
     
+    // Incremental evaluation terms, summed over the pieces on the board
+    int midgameScore;
+    int endgameScore;
+    int gamePhase;
+    uint64_t pieceKey; // Zobrist key of the piece placement (Polyglot piece entries)
+    uint64_t pawnKey; // Zobrist key of the pawns alone
+    int halfmoveClock;
+    std::vector<uint64_t> keyHistory;
+    const NnueNetwork* network; // Not owned; copied boards share it
+    NnueAccumulator accumulator; // Only maintained while a network is set
+    
+    // All piece placement goes through these so the incremental terms stay in sync
+    void placePiece(int x, int y, Piece* piece);
+    Piece* liftPiece(int x, int y);
+    void capturePiece(int x, int y);
+    void clearBoard();
+    void resetTerms(); // Rights, en passant and incremental terms of an empty board; pieces stay
     void setupPieces();
+    void applyMove(int x1, int y1, int x2, int y2);
     bool canMoveWithoutLeavingCheck(int x1, int y1, int x2, int y2, bool isWhiteKing) const;
+    void generatePieceMoves(int x, int y, bool captures, bool quiets, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const;
     Piece* createPieceCopy(Piece* original) const; // Helper for copy constructor
     void recordPieceMovement(int x, int y); // Record that a piece has moved
 };
@@ -0,0 +1,81 @@
+#ifndef ENDGAMETABLEBASE_H
+#define ENDGAMETABLEBASE_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Win/draw/loss values stored in a .wdl table, from the side to move's view
+enum TablebaseWDL {
+    TB_UNKNOWN = 0, // Illegal or unreachable position
+    TB_LOSS = 1,
+    TB_DRAW = 2,
+    TB_WIN = 3
+};
+
+// Endgame tables for one material signature, e.g. "KQvK".
+//
+// File layout (both files): a 16-byte TablebaseHeader, then one value per
+// index. .wdl files pack four 2-bit TablebaseWDL values per byte; .dtm files
+// hold one byte per index with the distance to mate in plies (255 = unknown).
+// Positions are indexed by the squares (x * 8 + y) of the header's pieces and
+// the side to move: index = stm + 2 * (sq0 + 64 * (sq1 + 64 * ...)).
+struct TablebaseHeader {
+    char magic[4];      // "CTB1"
+    uint8_t kind;       // 0 = WDL, 1 = DTM
+    uint8_t pieceCount;
+    char pieces[6];     // Piece symbols in index order, white first ("KQk")
+    uint32_t reserved;
+};
+
+class EndgameTablebase {
+public:
+    EndgameTablebase();
+
+    // Maps every table for up to MAX_PIECES pieces found in the directory
+    bool loadDirectory(const std::string& path);
+    void close();
+    bool isLoaded() const { return !tables.empty(); }
+    int getMaxPieces() const { return maxPieces; }
+    size_t getTableCount() const { return tables.size(); }
+    const std::string& getPath() const { return directory; }
+
+    // Probes return false when the position is not covered by a loaded table
+    bool probeWDL(const Board& board, bool whiteToMove, int& wdl) const;
+    bool probeDTM(const Board& board, bool whiteToMove, int& wdl, int& pliesToMate) const;
+
+    // Picks the tablebase-optimal move: fastest win, slowest loss. False if a table
+    // is missing, or if the position is won or lost and a move's distance to mate is not
+    // known (a table with no .dtm file), so the search chooses
+    bool probeRoot(const Board& board, bool whiteToMove, std::pair<std::pair<int, int>, std::pair<int, int>>& move) const;
+
+    static const int MAX_PIECES = 4;
+    static std::string getSignature(const Board& board, bool swapColors);
+    static std::string getTablePieces(const std::string& signature);
+    static uint64_t getTableSize(int pieceCount) { return 2ULL << (6 * pieceCount); }
+    static bool hasCastlingRights(const Board& board);
+
+private:
+    struct Table {
+        std::string pieces;
+        uint64_t size;
+        MappedFile wdl;
+        MappedFile dtm; // Optional
+    };
+
+    std::string directory;
+    std::vector<std::unique_ptr<Table>> tables;
+    std::map<std::string, size_t> tableIndex; // Signature -> tables slot
+    int maxPieces;
+
+    bool openTable(const std::string& signature);
+    // Finds the table and index of a position; swaps colours when only the
+    // mirrored signature has a table
+    const Table* locate(const Board& board, bool whiteToMove, uint64_t& index) const;
+};
+
+#endif
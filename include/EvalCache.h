@@ -0,0 +1,32 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+// Fixed-size cache of static evaluations keyed by position hash. It is safe
+// to share between search threads without locks: each slot stores the key
+// XORed with its data, so a slot torn by concurrent writers fails the key
+// check and reads as a miss instead of returning another position's score.
+class EvalCache {
+public:
+    explicit EvalCache(size_t sizeKB = 1024);
+
+    void resize(size_t sizeKB);
+    void clear();
+    bool probe(uint64_t key, int& score) const;
+    void store(uint64_t key, int score);
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;  // Valid bit 32 | score in the low 32 bits
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    size_t mask;
+};
+
+#endif
@@ -2,8 +2,22 @@
 #define GAME_H
 
 #include "Board.h"
+#include "TranspositionTable.h"
+#include "MovePicker.h"
+#include "PawnHashTable.h"
+#include "EvalCache.h"
+#include "OpeningBook.h"
+#include "EndgameTablebase.h"
+#include "NnueNetwork.h"
+#include "GameJournal.h"
 #include <vector>
 #include <string>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
 
 enum class AIDifficulty {
     RANDOM,
@@ -20,19 +34,98 @@ struct Move {
         notation = std::to_string(x1) + "," + std::to_string(y1) + " to " + 
                    std::to_string(x2) + "," + std::to_string(y2);
     }
+    Move(int x1, int y1, int x2, int y2, const std::string& san) : x1(x1), y1(y1), x2(x2), y2(y2), notation(san) {}
+};
+
+// Statistics collected by one AI search
+struct SearchStats {
+    uint64_t nodes = 0;              // All nodes, including quiescence nodes
+    uint64_t quiescenceNodes = 0;
+    uint64_t exchangePrunes = 0;     // Quiescence captures skipped as losing exchanges
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;   // Cutoffs produced by the first move searched
+    uint64_t quietGenerations = 0;   // Nodes that had to generate their quiet moves
+    uint64_t checkExtensions = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t tbHits = 0;             // Nodes resolved by the endgame tables
+    uint64_t evalProbes = 0;
+    uint64_t evalHits = 0;
+    uint64_t pawnProbes = 0;
+    uint64_t pawnHits = 0;
+    int depth = 0;                   // Last fully completed iteration
+    int selectiveDepth = 0;          // Deepest ply reached, including quiescence
+    double seconds = 0.0;
+    
+    uint64_t nodesPerSecond() const { return seconds > 0 ? static_cast<uint64_t>(nodes / seconds) : nodes; }
+    double firstMoveCutoffRate() const { return betaCutoffs ? 100.0 * firstMoveCutoffs / betaCutoffs : 0.0; }
+    double quietGenerationRate() const {
+        uint64_t searchNodes = nodes - quiescenceNodes;
+        return searchNodes ? 100.0 * quietGenerations / searchNodes : 0.0;
+    }
+    double ttHitRate() const { return ttProbes ? 100.0 * ttHits / ttProbes : 0.0; }
+    double evalHitRate() const { return evalProbes ? 100.0 * evalHits / evalProbes : 0.0; }
+    double pawnHitRate() const { return pawnProbes ? 100.0 * pawnHits / pawnProbes : 0.0; }
+};
+
+// Budget for Game::searchPosition; zero means unlimited
+struct SearchLimits {
+    int depth = 0;
+    int moveTime = 0;    // Milliseconds
+    uint64_t nodes = 0;
+};
+
+// One root move of a multi-PV analysis
+struct AnalysisLine {
+    std::pair<std::pair<int, int>, std::pair<int, int>> move;
+    int score; // Centipawns, positive favours White
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> pv; // Starts with move
 };
 
 class Game {
 public:
     Game();
+    ~Game();
     void start();
     void displayHelp() const;
     void setAIOpponent(bool enabled, AIDifficulty difficulty = AIDifficulty::RANDOM);
     void setAIPlaysAs(bool playsAsWhite);
+    void setPondering(bool enabled);
+    bool setOpeningBook(const std::string& path); // Empty path disables the book
+    bool setTablebasePath(const std::string& path); // Empty path disables the tables
+    bool setNetwork(const std::string& path); // Empty path selects the piece-square tables
+    
+    // Best `lines` root moves, best first, each with its score and principal variation
+    std::vector<AnalysisLine> analyze(const Board& position, bool forWhite, int depth, int lines);
+    
+    // Headless search for engine front ends. onIteration runs after every completed
+    // depth with the statistics so far, the score (centipawns, positive favours
+    // White) and the principal variation. setSearchStopped(true) may be called from
+    // another thread to end the search early; clear it again once the search returned
+    std::pair<std::pair<int, int>, std::pair<int, int>> searchPosition(
+        const Board& position, bool forWhite, const SearchLimits& limits,
+        const std::function<void(const SearchStats&, int, const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>&)>& onIteration);
+    void setSearchStopped(bool stopped) { searchStopped = stopped; }
+    
+    // Move an AI of the given difficulty would play in any position, without touching
+    // this game's state. A budget in limits replaces the difficulty's fixed depth.
+    // Returns {{-1,-1},{-1,-1}} if there is no legal move
+    std::pair<std::pair<int, int>, std::pair<int, int>> chooseMove(const Board& position, bool forWhite,
+                                                                   AIDifficulty difficulty, const SearchLimits& limits);
+    static int mateDistance(int score); // Moves to mate, negative when Black mates; 0 if score is not a mate
+    void clearSearchTables(); // Forget everything learned from earlier searches
+    void setShowSearchStats(bool enabled);
+    // Statistics of the last AI move's search, or of the last searchPosition; a copy,
+    // so the ponder thread's searches neither change nor race with it
+    SearchStats getLastSearchStats() const;
     
-    // Save/Load methods
-    bool saveGame(const std::string& filename) const;
-    bool loadGame(const std::string& filename);
+    // Save/Load methods. saveGame starts a journal (GameJournal) that records every
+    // later move as it is made; archiveGame appends the game to a binary archive
+    // (GameArchive). loadGame recovers a journal, or takes an archive's game
+    // `number`, counted from 1, or its last game for 0
+    bool saveGame(const std::string& filename);
+    bool archiveGame(const std::string& filename) const;
+    bool loadGame(const std::string& filename, size_t number = 0);
     bool exportPGN(const std::string& filename) const;
     bool importPGN(const std::string& filename);
     std::string getFEN() const;
@@ -44,12 +137,44 @@ private:
     bool currentPlayer; // true = white, false = black
     int moveCount;
     std::vector<Move> moveHistory;
+    std::string initialFEN; // Position moveHistory starts from; empty for the standard start
+    GameJournal journal; // Open once the game is saved; each move is appended to it
     
     // AI variables
     bool aiEnabled;
     AIDifficulty aiDifficulty;
     bool aiPlaysAsWhite;
     
+    // Search state
+    TranspositionTable transpositionTable;
+    PawnHashTable pawnTable;
+    EvalCache evalCache; // Shared with the ponder thread
+    std::atomic<bool> searchStopped;
+    SearchStats searchStats; // The running search's, the ponder thread's included
+    SearchStats lastSearchStats; // Kept from the last AI move or searchPosition
+    static const int MAX_PLY = 64;
+    int killerMoves[MAX_PLY][2]; // Quiet moves that last cut off at each ply, packed
+    int rootDepth; // Depth of the current iteration; bounds check extensions
+    uint64_t nodeLimit; // searchPosition budget, 0 if none
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point searchDeadline;
+    bool showSearchStats;
+    OpeningBook openingBook;
+    EndgameTablebase tablebase;
+    NnueNetwork network;
+    
+    // Pondering: searching the human's possible replies in the background
+    bool ponderEnabled;
+    std::thread ponderThread;
+    std::atomic<bool> ponderStopRequested;
+    std::atomic<uint64_t> ponderCurrentKey; // Position the ponder thread is searching
+    std::mutex ponderMutex;
+    struct PonderResult {
+        std::pair<std::pair<int, int>, std::pair<int, int>> move;
+        SearchStats stats;
+    };
+    std::map<uint64_t, PonderResult> ponderResults;
+    
     // Helper methods
     bool makeMove(int x1, int y1, int x2, int y2);
     bool isValidMove(int x1, int y1, int x2, int y2) const;
@@ -58,9 +183,15 @@ private:
     void showLegalMoves(int x, int y) const;
     bool handleSpecialCommands(const std::string& input);
     void makeAIMove();
-    int evaluatePosition() const;
-    int minimax(Board& board, int depth, int alpha, int beta, bool maximizingPlayer) const;
+    int minimax(Board& board, int depth, int alpha, int beta, bool maximizingPlayer, int ply);
+    int quiescence(Board& board, int alpha, int beta, bool maximizingPlayer, int ply);
+    void clearKillers();
+    void checkSearchLimits();
+    void storeKiller(int ply, int move);
+    int evaluate(const Board& position);
+    void displaySearchStats() const;
     std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> getAllLegalMoves(bool forWhite) const;
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> getAllLegalMoves(const Board& position, bool forWhite) const;
     void displayAISettings() const;
     
     // Chess notation helpers
@@ -69,20 +200,34 @@ private:
     
     // Game state methods
     bool isGameEnded() const;
+    std::string getResult() const; // PGN result of the current position, "*" while the game goes on
+    PgnGame toRecord(bool withSettings) const; // Tags, start position, moves and result; AI settings as tags
+    bool loadRecord(const PgnGame& game); // Replays a recorded game; false if its start position is invalid
     void announceGameEnd() const;
     
     // AI helper methods
     std::pair<std::pair<int, int>, std::pair<int, int>> getRandomMove() const;
+    std::pair<std::pair<int, int>, std::pair<int, int>> getRandomMove(const Board& position, bool forWhite) const;
     std::pair<std::pair<int, int>, std::pair<int, int>> getGreedyMove() const;
-    std::pair<std::pair<int, int>, std::pair<int, int>> getMinimaxMove(int depth) const;
+    std::pair<std::pair<int, int>, std::pair<int, int>> getGreedyMove(const Board& position, bool forWhite) const;
+    std::pair<std::pair<int, int>, std::pair<int, int>> getMinimaxMove(const Board& position, bool forWhite, int depth);
+    std::pair<std::pair<int, int>, std::pair<int, int>> searchRoot(const Board& position, bool forWhite, int depth,
+                                                                   std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& legalMoves,
+                                                                   int* value = nullptr);
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> extractPV(const Board& position, bool forWhite,
+                                                                              const std::pair<std::pair<int, int>, std::pair<int, int>>& first,
+                                                                              int maxLength);
+    std::string formatScore(int score) const;
     int getPieceValue(char piece) const;
+    int getSearchDepth() const;
+    
+    // Pondering helpers
+    void startPondering();
+    void stopPondering(bool finishCurrent);
+    void ponderLoop(Board position, bool humanIsWhite, int depth, int predictedMove);
+    bool takePonderResult(std::pair<std::pair<int, int>, std::pair<int, int>>& move);
     
     // Move parsing methods
-    std::pair<std::pair<int, int>, std::pair<int, int>> findPawnMove(int destX, int destY) const;
-    std::pair<std::pair<int, int>, std::pair<int, int>> findPieceMove(char pieceType, int destX, int destY) const;
-    std::pair<std::pair<int, int>, std::pair<int, int>> findPawnCapture(int fromFile, int destX, int destY) const;
-    std::pair<std::pair<int, int>, std::pair<int, int>> parseCastlingNotation(const std::string& notation) const;
-    std::pair<std::pair<int, int>, std::pair<int, int>> parseAlgebraicNotation(const std::string& notation) const;
     bool processInput(const std::string& input);
 };
 
@@ -0,0 +1,104 @@
+#ifndef GAMEARCHIVE_H
+#define GAMEARCHIVE_H
+
+#include "MappedFile.h"
+#include "PgnReader.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary multi-game archive (.chess files).
+//
+// File layout: a 24-byte ArchiveHeader, the game records, then the index, which
+// holds the uint64 byte offsets of the start and end of each game's record. All
+// integers are little-endian. Game N is found through the index without reading
+// any other game. Appending leaves the old index in place and writes the new
+// records and a new index after it, so bytes no index entry covers can lie
+// between records and after the index; the header is always the last thing
+// written, so a file cut short by a crash still reads as it was.
+//
+// Game record, every count and length a varint (7 bits per byte, low bits first):
+// the tag count, then each tag as name length, name, value length, value; the
+// start FEN length and text (0 for the standard start); one result byte (0 = "*",
+// 1 = "1-0", 2 = "0-1", 3 = "1/2-1/2"); the move count, then each move as its index
+// among the Board::getCandidateTargets of the mover's pieces, taken piece by piece
+// from a8 to h1 in the position it was played in. That order is part of the format,
+// so VERSION changes with it.
+struct ArchiveHeader {
+    char magic[4];        // "CGA1"
+    uint16_t version;
+    uint16_t flags;       // Reserved, 0
+    uint32_t gameCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+};
+
+// Read-only view of an archive. The file is memory-mapped and games are decoded
+// straight from the mapped bytes on request.
+class GameArchive {
+public:
+    GameArchive();
+
+    // False if the file is missing or is not an archive of this version
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    size_t size() const { return gameCount; }
+
+    // Game `index`, counted from 0. False if there is no such game; a record that
+    // does not decode is still returned, with its error set and its legal moves kept
+    bool readGame(size_t index, PgnGame& game) const;
+
+    // False, leaving bytes as they were, if a move is not legal in the replayed position
+    static bool encode(const PgnGame& game, std::string& bytes);
+    static void decode(const unsigned char* begin, const unsigned char* end, PgnGame& game);
+    static ArchiveHeader readHeader(const unsigned char* bytes);
+    static void writeHeader(const ArchiveHeader& header, unsigned char* bytes);
+
+    static const uint16_t VERSION = 2;
+    static const size_t HEADER_SIZE = 24;
+    static const size_t INDEX_ENTRY_SIZE = 16;
+
+private:
+    MappedFile file;
+    size_t gameCount;
+    uint64_t indexOffset;
+};
+
+// Writes games to an archive, new or existing. Records are collected in a memory
+// buffer and written in large blocks; the index and header follow on close. A new
+// archive that was not closed is not readable, and an existing one keeps the games
+// it had before the append.
+class GameArchiveWriter {
+public:
+    GameArchiveWriter();
+    ~GameArchiveWriter(); // Closes
+    GameArchiveWriter(const GameArchiveWriter&) = delete;
+    GameArchiveWriter& operator=(const GameArchiveWriter&) = delete;
+
+    // With append, the games of an existing archive are kept and new ones follow
+    // them; a missing file is created either way. False if the file cannot be
+    // opened or an existing file is not an archive
+    bool open(const std::string& path, bool append = false);
+    bool close(); // False if the archive could not be completed
+    bool isOpen() const { return file.is_open(); }
+    size_t getGameCount() const { return records.size(); }
+
+    // False, writing nothing, if a move is not legal in the replayed position
+    bool write(const PgnGame& game);
+
+private:
+    std::fstream file;
+    std::string buffer;
+    std::vector<std::pair<uint64_t, uint64_t>> records; // Start and end offset of each game
+    uint64_t dataEnd; // File offset after the last record, buffered ones included
+    bool failed;
+
+    bool flush();
+    bool readIndex(); // Positions an existing archive's file for appending after its end
+
+    static const size_t FLUSH_SIZE = 1 << 20;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef GAMEJOURNAL_H
+#define GAMEJOURNAL_H
+
+#include "PgnReader.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Append-only journal of the game being played, so saving costs one small
+// write per move however long the game is, and a crash loses at most the
+// moves not yet synced.
+//
+// File layout: "CGJ1", a uint16 version and a uint16 reserved field, then
+// records. A record is a type byte, a varint payload length, the payload and
+// a CRC-32 of the three, all integers little-endian. A GAME record starts a
+// game (the tag count and tags as length-prefixed strings, then the start FEN,
+// empty for the standard start); each MOVE record holds the from and to
+// squares (x * 8 + y) of one move of the latest game.
+class GameJournal {
+public:
+    GameJournal();
+    ~GameJournal(); // Closes
+    GameJournal(const GameJournal&) = delete;
+    GameJournal& operator=(const GameJournal&) = delete;
+
+    // Starts a journal at path with the game so far, synced before returning. It
+    // is written beside path and renamed over it, so a crash leaves the old file or
+    // the new journal. False, leaving the file alone, if path holds anything but a journal
+    bool create(const std::string& path, const PgnGame& game);
+    // Continues a recovered journal, first cutting off anything after validBytes
+    bool resume(const std::string& path, uint64_t validBytes);
+    void close(); // Syncs
+    bool isOpen() const { return file != nullptr; }
+    const std::string& getPath() const { return path; }
+
+    // Writes one record straight to the operating system, so it survives the
+    // process crashing; it is synced to disk with every syncBatch-th record
+    bool appendMove(int x1, int y1, int x2, int y2);
+    bool sync();
+    void setSyncBatch(int records) { syncBatch = records > 0 ? records : 1; }
+
+    // Replays the journal's last game up to its last valid record. False if the
+    // file is missing, is not a journal or holds no readable game. A torn or
+    // corrupt tail, or a move that is not legal when replayed, ends the game there
+    // and sets its error; the records before it take validBytes of the file
+    static bool recover(const std::string& path, PgnGame& game, uint64_t& validBytes);
+
+    static const uint16_t VERSION = 1;
+    static const size_t HEADER_SIZE = 8;
+    static const int SYNC_BATCH = 16;
+
+private:
+    std::FILE* file;
+    std::string path;
+    int syncBatch;
+    int unsynced; // Records written since the last sync
+
+    bool writeRecord(unsigned char type, const std::string& payload);
+};
+
+#endif
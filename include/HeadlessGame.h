@@ -0,0 +1,62 @@
+#ifndef HEADLESSGAME_H
+#define HEADLESSGAME_H
+
+#include "Board.h"
+#include "Game.h"
+#include "PgnReader.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// One engine configuration for headless play: how it picks moves and what it
+// evaluates with. Written as "<strength>[,eval=<file>|pst]" where strength is
+// random, greedy, minimax1..minimax3, depthN, nodesN or movetimeN (milliseconds)
+struct EngineConfig {
+    std::string name;
+    AIDifficulty difficulty = AIDifficulty::MINIMAX_2;
+    SearchLimits limits;
+    std::string network; // Empty keeps the default network, "pst" selects the piece-square tables
+
+    bool parse(const std::string& spec);
+    bool apply(Game& engine) const; // Sets up the evaluator; false if the network cannot be loaded
+};
+
+// A game between two engines from a given position, with no console I/O. It
+// ends on mate, stalemate, threefold repetition, the fifty-move rule or
+// insufficient material, or is adjudicated drawn after maxPlies.
+class HeadlessGame {
+public:
+    HeadlessGame(const std::string& fen, int maxPlies);
+
+    // The first randomPlies plies are drawn from the seed, so two games with the
+    // same seed and opening start identically
+    void play(Game& white, const EngineConfig& whiteConfig, Game& black, const EngineConfig& blackConfig,
+              int randomPlies, unsigned seed);
+
+    const std::string& getStartFEN() const { return startFEN; }
+    const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& getMoves() const { return moves; }
+    const std::string& getResult() const { return result; } // "1-0", "0-1", "1/2-1/2" or "*"
+    const std::string& getReason() const { return reason; }
+
+    // PGN record with the seven standard tags plus FEN and PlyCount, for PgnWriter
+    PgnGame toRecord(const std::string& event, const std::string& date, int round,
+                     const std::string& whiteName, const std::string& blackName) const;
+
+    static const char* const START_FEN;
+    
+    // FEN lines of an openings file, skipping blank lines, '#' comments and records
+    // that do not load. An empty path or a file without openings gives the start
+    // position. False if the file cannot be opened
+    static bool readOpenings(const std::string& path, std::vector<std::string>& openings);
+
+private:
+    std::string startFEN;
+    int maxPlies;
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> moves;
+    std::string result;
+    std::string reason;
+
+    static bool isInsufficientMaterial(const Board& board);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "Board.h"
+#include <utility>
+#include <vector>
+
+// Hands out the legal moves of one node in stages, generating each group only
+// when the previous one is used up: the hash move, captures that win or break
+// even by static exchange, the killer moves, quiet moves (checks first), and
+// finally losing captures. A node that cuts off early never generates its quiet moves.
+// Moves are packed as in TranspositionTable::packMove; -1 means none.
+class MovePicker {
+public:
+    // checkInfo is the node's Board::getCheckInfo(forWhite), which the search has
+    // already worked out; it must outlive the picker
+    MovePicker(const Board& board, bool forWhite, const CheckInfo& checkInfo, int hashMove, const int killers[2]);
+
+    // Next move to search; false once every legal move has been returned
+    bool next(std::pair<std::pair<int, int>, std::pair<int, int>>& move);
+    bool generatedQuiets() const { return stage > Stage::GENERATE_QUIETS; }
+
+private:
+    enum class Stage {
+        HASH_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        GENERATE_QUIETS,
+        QUIET_MOVES,
+        BAD_CAPTURES,
+        DONE
+    };
+
+    const Board& board;
+    bool forWhite;
+    const CheckInfo& checkInfo;
+    int hashMove;
+    int killers[2];
+    Stage stage;
+    size_t index;
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> moves;
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> badCaptures;
+
+    bool isLegal(int packedMove) const;
+    bool isHashOrKiller(const std::pair<std::pair<int, int>, std::pair<int, int>>& move) const;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef NNUENETWORK_H
+#define NNUENETWORK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct NnueAccumulator;
+
+// Efficiently updatable neural network evaluator: 768 piece-square features
+// per perspective -> 2 x 128 (clipped ReLU) -> 32 (clipped ReLU) -> 1.
+//
+// Weight file layout, little-endian:
+//   "NNU1", uint32 inputs (768), uint32 hidden (128), uint32 layer1 (32)
+//   int16 featureBias[hidden], int16 featureWeights[inputs][hidden]
+//   int32 layer1Bias[layer1], int8 layer1Weights[layer1][2 * hidden]
+//   int32 outputBias, int8 outputWeights[layer1]
+// Accumulators are clipped to [0, 127], layer 1 sums are shifted right by
+// LAYER1_SHIFT and clipped to [0, 127], and the output divided by
+// OUTPUT_SCALE is the score in centipawns from White's point of view.
+class NnueNetwork {
+public:
+    static const int INPUTS = 768;
+    static const int HIDDEN = 128;
+    static const int LAYER1 = 32;
+    static const int LAYER1_SHIFT = 6;
+    static const int OUTPUT_SCALE = 16;
+
+    NnueNetwork();
+
+    bool load(const std::string& path);
+    bool isLoaded() const { return loaded; }
+    const std::string& getPath() const { return path; }
+
+    // Incremental accumulator maintenance
+    void resetAccumulator(NnueAccumulator& accumulator) const;
+    void addPiece(NnueAccumulator& accumulator, char symbol, int x, int y) const;
+    void removePiece(NnueAccumulator& accumulator, char symbol, int x, int y) const;
+
+    // Score in centipawns, positive favours White
+    int evaluate(const NnueAccumulator& accumulator) const;
+
+    // Instruction set the dense layers were compiled for ("AVX2", "SSE2" or "scalar")
+    static const char* getSimdName();
+
+private:
+    bool loaded;
+    std::string path;
+    std::vector<int16_t> featureBias;
+    std::vector<int16_t> featureWeights;  // [INPUTS][HIDDEN]
+    std::vector<int32_t> layer1Bias;
+    std::vector<int16_t> layer1Weights;   // [LAYER1][2 * HIDDEN], widened from int8
+    int32_t outputBias;
+    std::vector<int32_t> outputWeights;
+
+    static int featureIndex(int perspective, char symbol, int x, int y);
+};
+
+// First-layer outputs for White's and Black's perspective. Boards keep one up
+// to date by adding or subtracting a weight column whenever a piece is placed
+// or lifted, so evaluation only has to run the small dense layers.
+struct NnueAccumulator {
+    int16_t values[2][NnueNetwork::HIDDEN];
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// One 16-byte Polyglot book record (stored big-endian on disk)
+struct BookEntry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t learn;
+};
+
+class OpeningBook {
+public:
+    OpeningBook();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.isOpen() && entryCount > 0; }
+    const std::string& getPath() const { return path; }
+    size_t size() const { return entryCount; }
+
+    // Picks a book move for the position, weighted by entry weight.
+    // Returns false when the position is not in the book.
+    bool probe(const Board& board, bool whiteToMove, std::pair<std::pair<int, int>, std::pair<int, int>>& move);
+    std::vector<BookEntry> getEntries(uint64_t key) const;
+
+    // Polyglot move encoding <-> board coordinates (x = row from the top, y = file)
+    static uint16_t encodeMove(const Board& board, int x1, int y1, int x2, int y2);
+    static std::pair<std::pair<int, int>, std::pair<int, int>> decodeMove(const Board& board, uint16_t move);
+    static BookEntry readEntry(const unsigned char* bytes);
+    static void writeEntry(const BookEntry& entry, unsigned char* bytes);
+
+private:
+    MappedFile file;
+    std::string path;
+    size_t entryCount;
+    std::mt19937 rng;
+
+    size_t lowerBound(uint64_t key) const;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef PAWNHASHTABLE_H
+#define PAWNHASHTABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Cached pawn-structure score of one pawn configuration, from White's side
+struct PawnEntry {
+    uint64_t key;
+    int midgame;
+    int endgame;
+    bool valid;
+};
+
+// Small always-replace cache indexed by Board::getPawnKey()
+class PawnHashTable {
+public:
+    explicit PawnHashTable(size_t sizeKB = 256);
+
+    void resize(size_t sizeKB);
+    void clear();
+    bool probe(uint64_t key, PawnEntry& entry) const;
+    void store(uint64_t key, int midgame, int endgame);
+
+private:
+    std::vector<PawnEntry> entries;
+    size_t mask;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef PGNREADER_H
+#define PGNREADER_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One game of a PGN file, its SAN movetext replayed into board coordinates
+struct PgnGame {
+    std::vector<std::pair<std::string, std::string>> tags; // In file order
+    std::string startFEN; // Empty for the standard starting position
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> moves;
+    std::string result; // Game termination marker, or the Result tag if there is none
+    std::string error;  // Why the game stopped being replayed; moves holds the legal prefix
+
+    bool isValid() const { return error.empty(); }
+    std::string getTag(const std::string& name) const; // Empty if absent
+};
+
+// Reads the games of a PGN file one at a time. The file is memory-mapped, so a
+// multi-gigabyte database is paged in as it is read and never held in memory.
+// Comments, variations, NAGs and escape lines are skipped; SAN moves are matched
+// against the legal moves of the replayed position.
+class PgnReader {
+public:
+    PgnReader();
+
+    bool open(const std::string& path);
+    // Reads a slice of PGN text, which must start at a game boundary and outlive the reader
+    void setText(const char* begin, const char* end);
+
+    // False once no game is left. A game whose movetext cannot be replayed is still
+    // returned, with its error set
+    bool next(PgnGame& game);
+    uint64_t getBytesRead() const { return static_cast<uint64_t>(cursor - begin); }
+
+private:
+    MappedFile file;
+    const char* begin;
+    const char* cursor;
+    const char* end;
+
+    void skipLine();
+    void readTag(PgnGame& game);
+    void readMovetext(PgnGame& game);
+};
+
+#endif
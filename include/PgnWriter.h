@@ -0,0 +1,38 @@
+#ifndef PGNWRITER_H
+#define PGNWRITER_H
+
+#include "PgnReader.h"
+#include <fstream>
+#include <string>
+
+// Writes games to one PGN file in SAN. Games are collected in a memory buffer
+// and written in large blocks, so producing millions of games costs a few
+// system calls per megabyte rather than one file open per game.
+class PgnWriter {
+public:
+    PgnWriter();
+    ~PgnWriter(); // Flushes
+    PgnWriter(const PgnWriter&) = delete;
+    PgnWriter& operator=(const PgnWriter&) = delete;
+
+    bool open(const std::string& path, bool append = false);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    // False, writing nothing, if a move is not legal in the replayed position
+    bool write(const PgnGame& game, const std::string& comment = "");
+    bool flush();
+
+    // The game as PGN text: its tags in order with Result set to the game's result,
+    // SetUp and FEN when it starts from a set-up position, and the moves in SAN,
+    // wrapped below 80 columns. An optional comment goes before the result
+    static bool format(const PgnGame& game, const std::string& comment, std::string& text);
+
+private:
+    std::ofstream file;
+    std::string buffer;
+
+    static const size_t FLUSH_SIZE = 1 << 20;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Bound type of a stored search score
+enum class TTFlag : uint8_t {
+    NONE,
+    EXACT,
+    LOWER, // Score is at least this value (beta cutoff)
+    UPPER  // Score is at most this value (failed low)
+};
+
+struct TTEntry {
+    uint64_t key;
+    int score;
+    int depth;
+    int bestMove; // Packed move, -1 if none
+    TTFlag flag;
+};
+
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t sizeMB = 16);
+
+    void resize(size_t sizeMB);
+    void clear();
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, int score, int depth, TTFlag flag, int bestMove);
+
+    // Moves are packed as (from * 64 + to) with squares numbered x * 8 + y
+    static int packMove(int x1, int y1, int x2, int y2) {
+        return ((x1 * 8 + y1) << 6) | (x2 * 8 + y2);
+    }
+    static void unpackMove(int move, int& x1, int& y1, int& x2, int& y2) {
+        int from = (move >> 6) & 63;
+        int to = move & 63;
+        x1 = from / 8; y1 = from % 8;
+        x2 = to / 8; y2 = to % 8;
+    }
+
+private:
+    std::vector<TTEntry> entries;
+    size_t mask;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef UCIENGINE_H
+#define UCIENGINE_H
+
+#include "Game.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Universal Chess Interface front end on stdin/stdout. Commands are read on
+// the calling thread while searches run on a worker thread, so "stop" and
+// "isready" are answered during a search. Nothing is rendered; the only output
+// is protocol text, with an "info" line after every completed depth.
+class UciEngine {
+public:
+    UciEngine();
+    ~UciEngine();
+
+    void run(); // Returns after "quit" or the end of input
+
+private:
+    Game game;
+    Board position;
+    bool whiteToMove;
+    std::thread searchThread;
+    std::mutex outputMutex;
+    std::atomic<bool> infinite;      // "go infinite": hold bestmove until "stop"
+    std::atomic<bool> stopRequested;
+
+    void send(const std::string& line);
+    void setPosition(const std::string& arguments);
+    void go(const std::string& arguments);
+    void stopSearch();
+
+    // Long algebraic notation of a move in board, with "q" on promotions
+    static std::string moveToUci(const Board& board, const std::pair<std::pair<int, int>, std::pair<int, int>>& move);
+    // False unless text is a legal move of the side to move in board
+    static bool uciToMove(const Board& board, bool whiteToMove, const std::string& text,
+                          std::pair<std::pair<int, int>, std::pair<int, int>>& move);
+};
+
+#endif
@@ -7,13 +7,444 @@
 #include "Pieces/King.h"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <sstream>
 
-Board::Board() : gameOver(false), gameStatus("ongoing"), enPassantTarget(-1, -1) {
+namespace {
+
+// Zobrist random numbers: Polyglot's Random64 array, so keys match the ones
+// Polyglot books are built with. 0-767 pieces, 768-771 castling rights,
+// 772-779 en passant file, 780 side to move
+const int ZOBRIST_CASTLING = 768;
+const int ZOBRIST_EN_PASSANT = 772;
+const int ZOBRIST_TURN = 780;
+
+const std::array<uint64_t, 781> ZOBRIST_RANDOM = {{
+    0x9D39247E33776D41ULL, 0x2AF7398005AAA5C7ULL, 0x44DB015024623547ULL, 0x9C15F73E62A76AE2ULL,
+    0x75834465489C0C89ULL, 0x3290AC3A203001BFULL, 0x0FBBAD1F61042279ULL, 0xE83A908FF2FB60CAULL,
+    0x0D7E765D58755C10ULL, 0x1A083822CEAFE02DULL, 0x9605D5F0E25EC3B0ULL, 0xD021FF5CD13A2ED5ULL,
+    0x40BDF15D4A672E32ULL, 0x011355146FD56395ULL, 0x5DB4832046F3D9E5ULL, 0x239F8B2D7FF719CCULL,
+    0x05D1A1AE85B49AA1ULL, 0x679F848F6E8FC971ULL, 0x7449BBFF801FED0BULL, 0x7D11CDB1C3B7ADF0ULL,
+    0x82C7709E781EB7CCULL, 0xF3218F1C9510786CULL, 0x331478F3AF51BBE6ULL, 0x4BB38DE5E7219443ULL,
+    0xAA649C6EBCFD50FCULL, 0x8DBD98A352AFD40BULL, 0x87D2074B81D79217ULL, 0x19F3C751D3E92AE1ULL,
+    0xB4AB30F062B19ABFULL, 0x7B0500AC42047AC4ULL, 0xC9452CA81A09D85DULL, 0x24AA6C514DA27500ULL,
+    0x4C9F34427501B447ULL, 0x14A68FD73C910841ULL, 0xA71B9B83461CBD93ULL, 0x03488B95B0F1850FULL,
+    0x637B2B34FF93C040ULL, 0x09D1BC9A3DD90A94ULL, 0x3575668334A1DD3BULL, 0x735E2B97A4C45A23ULL,
+    0x18727070F1BD400BULL, 0x1FCBACD259BF02E7ULL, 0xD310A7C2CE9B6555ULL, 0xBF983FE0FE5D8244ULL,
+    0x9F74D14F7454A824ULL, 0x51EBDC4AB9BA3035ULL, 0x5C82C505DB9AB0FAULL, 0xFCF7FE8A3430B241ULL,
+    0x3253A729B9BA3DDEULL, 0x8C74C368081B3075ULL, 0xB9BC6C87167C33E7ULL, 0x7EF48F2B83024E20ULL,
+    0x11D505D4C351BD7FULL, 0x6568FCA92C76A243ULL, 0x4DE0B0F40F32A7B8ULL, 0x96D693460CC37E5DULL,
+    0x42E240CB63689F2FULL, 0x6D2BDCDAE2919661ULL, 0x42880B0236E4D951ULL, 0x5F0F4A5898171BB6ULL,
+    0x39F890F579F92F88ULL, 0x93C5B5F47356388BULL, 0x63DC359D8D231B78ULL, 0xEC16CA8AEA98AD76ULL,
+    0x5355F900C2A82DC7ULL, 0x07FB9F855A997142ULL, 0x5093417AA8A7ED5EULL, 0x7BCBC38DA25A7F3CULL,
+    0x19FC8A768CF4B6D4ULL, 0x637A7780DECFC0D9ULL, 0x8249A47AEE0E41F7ULL, 0x79AD695501E7D1E8ULL,
+    0x14ACBAF4777D5776ULL, 0xF145B6BECCDEA195ULL, 0xDABF2AC8201752FCULL, 0x24C3C94DF9C8D3F6ULL,
+    0xBB6E2924F03912EAULL, 0x0CE26C0B95C980D9ULL, 0xA49CD132BFBF7CC4ULL, 0xE99D662AF4243939ULL,
+    0x27E6AD7891165C3FULL, 0x8535F040B9744FF1ULL, 0x54B3F4FA5F40D873ULL, 0x72B12C32127FED2BULL,
+    0xEE954D3C7B411F47ULL, 0x9A85AC909A24EAA1ULL, 0x70AC4CD9F04F21F5ULL, 0xF9B89D3E99A075C2ULL,
+    0x87B3E2B2B5C907B1ULL, 0xA366E5B8C54F48B8ULL, 0xAE4A9346CC3F7CF2ULL, 0x1920C04D47267BBDULL,
+    0x87BF02C6B49E2AE9ULL, 0x092237AC237F3859ULL, 0xFF07F64EF8ED14D0ULL, 0x8DE8DCA9F03CC54EULL,
+    0x9C1633264DB49C89ULL, 0xB3F22C3D0B0B38EDULL, 0x390E5FB44D01144BULL, 0x5BFEA5B4712768E9ULL,
+    0x1E1032911FA78984ULL, 0x9A74ACB964E78CB3ULL, 0x4F80F7A035DAFB04ULL, 0x6304D09A0B3738C4ULL,
+    0x2171E64683023A08ULL, 0x5B9B63EB9CEFF80CULL, 0x506AACF489889342ULL, 0x1881AFC9A3A701D6ULL,
+    0x6503080440750644ULL, 0xDFD395339CDBF4A7ULL, 0xEF927DBCF00C20F2ULL, 0x7B32F7D1E03680ECULL,
+    0xB9FD7620E7316243ULL, 0x05A7E8A57DB91B77ULL, 0xB5889C6E15630A75ULL, 0x4A750A09CE9573F7ULL,
+    0xCF464CEC899A2F8AULL, 0xF538639CE705B824ULL, 0x3C79A0FF5580EF7FULL, 0xEDE6C87F8477609DULL,
+    0x799E81F05BC93F31ULL, 0x86536B8CF3428A8CULL, 0x97D7374C60087B73ULL, 0xA246637CFF328532ULL,
+    0x043FCAE60CC0EBA0ULL, 0x920E449535DD359EULL, 0x70EB093B15B290CCULL, 0x73A1921916591CBDULL,
+    0x56436C9FE1A1AA8DULL, 0xEFAC4B70633B8F81ULL, 0xBB215798D45DF7AFULL, 0x45F20042F24F1768ULL,
+    0x930F80F4E8EB7462ULL, 0xFF6712FFCFD75EA1ULL, 0xAE623FD67468AA70ULL, 0xDD2C5BC84BC8D8FCULL,
+    0x7EED120D54CF2DD9ULL, 0x22FE545401165F1CULL, 0xC91800E98FB99929ULL, 0x808BD68E6AC10365ULL,
+    0xDEC468145B7605F6ULL, 0x1BEDE3A3AEF53302ULL, 0x43539603D6C55602ULL, 0xAA969B5C691CCB7AULL,
+    0xA87832D392EFEE56ULL, 0x65942C7B3C7E11AEULL, 0xDED2D633CAD004F6ULL, 0x21F08570F420E565ULL,
+    0xB415938D7DA94E3CULL, 0x91B859E59ECB6350ULL, 0x10CFF333E0ED804AULL, 0x28AED140BE0BB7DDULL,
+    0xC5CC1D89724FA456ULL, 0x5648F680F11A2741ULL, 0x2D255069F0B7DAB3ULL, 0x9BC5A38EF729ABD4ULL,
+    0xEF2F054308F6A2BCULL, 0xAF2042F5CC5C2858ULL, 0x480412BAB7F5BE2AULL, 0xAEF3AF4A563DFE43ULL,
+    0x19AFE59AE451497FULL, 0x52593803DFF1E840ULL, 0xF4F076E65F2CE6F0ULL, 0x11379625747D5AF3ULL,
+    0xBCE5D2248682C115ULL, 0x9DA4243DE836994FULL, 0x066F70B33FE09017ULL, 0x4DC4DE189B671A1CULL,
+    0x51039AB7712457C3ULL, 0xC07A3F80C31FB4B4ULL, 0xB46EE9C5E64A6E7CULL, 0xB3819A42ABE61C87ULL,
+    0x21A007933A522A20ULL, 0x2DF16F761598AA4FULL, 0x763C4A1371B368FDULL, 0xF793C46702E086A0ULL,
+    0xD7288E012AEB8D31ULL, 0xDE336A2A4BC1C44BULL, 0x0BF692B38D079F23ULL, 0x2C604A7A177326B3ULL,
+    0x4850E73E03EB6064ULL, 0xCFC447F1E53C8E1BULL, 0xB05CA3F564268D99ULL, 0x9AE182C8BC9474E8ULL,
+    0xA4FC4BD4FC5558CAULL, 0xE755178D58FC4E76ULL, 0x69B97DB1A4C03DFEULL, 0xF9B5B7C4ACC67C96ULL,
+    0xFC6A82D64B8655FBULL, 0x9C684CB6C4D24417ULL, 0x8EC97D2917456ED0ULL, 0x6703DF9D2924E97EULL,
+    0xC547F57E42A7444EULL, 0x78E37644E7CAD29EULL, 0xFE9A44E9362F05FAULL, 0x08BD35CC38336615ULL,
+    0x9315E5EB3A129ACEULL, 0x94061B871E04DF75ULL, 0xDF1D9F9D784BA010ULL, 0x3BBA57B68871B59DULL,
+    0xD2B7ADEEDED1F73FULL, 0xF7A255D83BC373F8ULL, 0xD7F4F2448C0CEB81ULL, 0xD95BE88CD210FFA7ULL,
+    0x336F52F8FF4728E7ULL, 0xA74049DAC312AC71ULL, 0xA2F61BB6E437FDB5ULL, 0x4F2A5CB07F6A35B3ULL,
+    0x87D380BDA5BF7859ULL, 0x16B9F7E06C453A21ULL, 0x7BA2484C8A0FD54EULL, 0xF3A678CAD9A2E38CULL,
+    0x39B0BF7DDE437BA2ULL, 0xFCAF55C1BF8A4424ULL, 0x18FCF680573FA594ULL, 0x4C0563B89F495AC3ULL,
+    0x40E087931A00930DULL, 0x8CFFA9412EB642C1ULL, 0x68CA39053261169FULL, 0x7A1EE967D27579E2ULL,
+    0x9D1D60E5076F5B6FULL, 0x3810E399B6F65BA2ULL, 0x32095B6D4AB5F9B1ULL, 0x35CAB62109DD038AULL,
+    0xA90B24499FCFAFB1ULL, 0x77A225A07CC2C6BDULL, 0x513E5E634C70E331ULL, 0x4361C0CA3F692F12ULL,
+    0xD941ACA44B20A45BULL, 0x528F7C8602C5807BULL, 0x52AB92BEB9613989ULL, 0x9D1DFA2EFC557F73ULL,
+    0x722FF175F572C348ULL, 0x1D1260A51107FE97ULL, 0x7A249A57EC0C9BA2ULL, 0x04208FE9E8F7F2D6ULL,
+    0x5A110C6058B920A0ULL, 0x0CD9A497658A5698ULL, 0x56FD23C8F9715A4CULL, 0x284C847B9D887AAEULL,
+    0x04FEABFBBDB619CBULL, 0x742E1E651C60BA83ULL, 0x9A9632E65904AD3CULL, 0x881B82A13B51B9E2ULL,
+    0x506E6744CD974924ULL, 0xB0183DB56FFC6A79ULL, 0x0ED9B915C66ED37EULL, 0x5E11E86D5873D484ULL,
+    0xF678647E3519AC6EULL, 0x1B85D488D0F20CC5ULL, 0xDAB9FE6525D89021ULL, 0x0D151D86ADB73615ULL,
+    0xA865A54EDCC0F019ULL, 0x93C42566AEF98FFBULL, 0x99E7AFEABE000731ULL, 0x48CBFF086DDF285AULL,
+    0x7F9B6AF1EBF78BAFULL, 0x58627E1A149BBA21ULL, 0x2CD16E2ABD791E33ULL, 0xD363EFF5F0977996ULL,
+    0x0CE2A38C344A6EEDULL, 0x1A804AADB9CFA741ULL, 0x907F30421D78C5DEULL, 0x501F65EDB3034D07ULL,
+    0x37624AE5A48FA6E9ULL, 0x957BAF61700CFF4EULL, 0x3A6C27934E31188AULL, 0xD49503536ABCA345ULL,
+    0x088E049589C432E0ULL, 0xF943AEE7FEBF21B8ULL, 0x6C3B8E3E336139D3ULL, 0x364F6FFA464EE52EULL,
+    0xD60F6DCEDC314222ULL, 0x56963B0DCA418FC0ULL, 0x16F50EDF91E513AFULL, 0xEF1955914B609F93ULL,
+    0x565601C0364E3228ULL, 0xECB53939887E8175ULL, 0xBAC7A9A18531294BULL, 0xB344C470397BBA52ULL,
+    0x65D34954DAF3CEBDULL, 0xB4B81B3FA97511E2ULL, 0xB422061193D6F6A7ULL, 0x071582401C38434DULL,
+    0x7A13F18BBEDC4FF5ULL, 0xBC4097B116C524D2ULL, 0x59B97885E2F2EA28ULL, 0x99170A5DC3115544ULL,
+    0x6F423357E7C6A9F9ULL, 0x325928EE6E6F8794ULL, 0xD0E4366228B03343ULL, 0x565C31F7DE89EA27ULL,
+    0x30F5611484119414ULL, 0xD873DB391292ED4FULL, 0x7BD94E1D8E17DEBCULL, 0xC7D9F16864A76E94ULL,
+    0x947AE053EE56E63CULL, 0xC8C93882F9475F5FULL, 0x3A9BF55BA91F81CAULL, 0xD9A11FBB3D9808E4ULL,
+    0x0FD22063EDC29FCAULL, 0xB3F256D8ACA0B0B9ULL, 0xB03031A8B4516E84ULL, 0x35DD37D5871448AFULL,
+    0xE9F6082B05542E4EULL, 0xEBFAFA33D7254B59ULL, 0x9255ABB50D532280ULL, 0xB9AB4CE57F2D34F3ULL,
+    0x693501D628297551ULL, 0xC62C58F97DD949BFULL, 0xCD454F8F19C5126AULL, 0xBBE83F4ECC2BDECBULL,
+    0xDC842B7E2819E230ULL, 0xBA89142E007503B8ULL, 0xA3BC941D0A5061CBULL, 0xE9F6760E32CD8021ULL,
+    0x09C7E552BC76492FULL, 0x852F54934DA55CC9ULL, 0x8107FCCF064FCF56ULL, 0x098954D51FFF6580ULL,
+    0x23B70EDB1955C4BFULL, 0xC330DE426430F69DULL, 0x4715ED43E8A45C0AULL, 0xA8D7E4DAB780A08DULL,
+    0x0572B974F03CE0BBULL, 0xB57D2E985E1419C7ULL, 0xE8D9ECBE2CF3D73FULL, 0x2FE4B17170E59750ULL,
+    0x11317BA87905E790ULL, 0x7FBF21EC8A1F45ECULL, 0x1725CABFCB045B00ULL, 0x964E915CD5E2B207ULL,
+    0x3E2B8BCBF016D66DULL, 0xBE7444E39328A0ACULL, 0xF85B2B4FBCDE44B7ULL, 0x49353FEA39BA63B1ULL,
+    0x1DD01AAFCD53486AULL, 0x1FCA8A92FD719F85ULL, 0xFC7C95D827357AFAULL, 0x18A6A990C8B35EBDULL,
+    0xCCCB7005C6B9C28DULL, 0x3BDBB92C43B17F26ULL, 0xAA70B5B4F89695A2ULL, 0xE94C39A54A98307FULL,
+    0xB7A0B174CFF6F36EULL, 0xD4DBA84729AF48ADULL, 0x2E18BC1AD9704A68ULL, 0x2DE0966DAF2F8B1CULL,
+    0xB9C11D5B1E43A07EULL, 0x64972D68DEE33360ULL, 0x94628D38D0C20584ULL, 0xDBC0D2B6AB90A559ULL,
+    0xD2733C4335C6A72FULL, 0x7E75D99D94A70F4DULL, 0x6CED1983376FA72BULL, 0x97FCAACBF030BC24ULL,
+    0x7B77497B32503B12ULL, 0x8547EDDFB81CCB94ULL, 0x79999CDFF70902CBULL, 0xCFFE1939438E9B24ULL,
+    0x829626E3892D95D7ULL, 0x92FAE24291F2B3F1ULL, 0x63E22C147B9C3403ULL, 0xC678B6D860284A1CULL,
+    0x5873888850659AE7ULL, 0x0981DCD296A8736DULL, 0x9F65789A6509A440ULL, 0x9FF38FED72E9052FULL,
+    0xE479EE5B9930578CULL, 0xE7F28ECD2D49EECDULL, 0x56C074A581EA17FEULL, 0x5544F7D774B14AEFULL,
+    0x7B3F0195FC6F290FULL, 0x12153635B2C0CF57ULL, 0x7F5126DBBA5E0CA7ULL, 0x7A76956C3EAFB413ULL,
+    0x3D5774A11D31AB39ULL, 0x8A1B083821F40CB4ULL, 0x7B4A38E32537DF62ULL, 0x950113646D1D6E03ULL,
+    0x4DA8979A0041E8A9ULL, 0x3BC36E078F7515D7ULL, 0x5D0A12F27AD310D1ULL, 0x7F9D1A2E1EBE1327ULL,
+    0xDA3A361B1C5157B1ULL, 0xDCDD7D20903D0C25ULL, 0x36833336D068F707ULL, 0xCE68341F79893389ULL,
+    0xAB9090168DD05F34ULL, 0x43954B3252DC25E5ULL, 0xB438C2B67F98E5E9ULL, 0x10DCD78E3851A492ULL,
+    0xDBC27AB5447822BFULL, 0x9B3CDB65F82CA382ULL, 0xB67B7896167B4C84ULL, 0xBFCED1B0048EAC50ULL,
+    0xA9119B60369FFEBDULL, 0x1FFF7AC80904BF45ULL, 0xAC12FB171817EEE7ULL, 0xAF08DA9177DDA93DULL,
+    0x1B0CAB936E65C744ULL, 0xB559EB1D04E5E932ULL, 0xC37B45B3F8D6F2BAULL, 0xC3A9DC228CAAC9E9ULL,
+    0xF3B8B6675A6507FFULL, 0x9FC477DE4ED681DAULL, 0x67378D8ECCEF96CBULL, 0x6DD856D94D259236ULL,
+    0xA319CE15B0B4DB31ULL, 0x073973751F12DD5EULL, 0x8A8E849EB32781A5ULL, 0xE1925C71285279F5ULL,
+    0x74C04BF1790C0EFEULL, 0x4DDA48153C94938AULL, 0x9D266D6A1CC0542CULL, 0x7440FB816508C4FEULL,
+    0x13328503DF48229FULL, 0xD6BF7BAEE43CAC40ULL, 0x4838D65F6EF6748FULL, 0x1E152328F3318DEAULL,
+    0x8F8419A348F296BFULL, 0x72C8834A5957B511ULL, 0xD7A023A73260B45CULL, 0x94EBC8ABCFB56DAEULL,
+    0x9FC10D0F989993E0ULL, 0xDE68A2355B93CAE6ULL, 0xA44CFE79AE538BBEULL, 0x9D1D84FCCE371425ULL,
+    0x51D2B1AB2DDFB636ULL, 0x2FD7E4B9E72CD38CULL, 0x65CA5B96B7552210ULL, 0xDD69A0D8AB3B546DULL,
+    0x604D51B25FBF70E2ULL, 0x73AA8A564FB7AC9EULL, 0x1A8C1E992B941148ULL, 0xAAC40A2703D9BEA0ULL,
+    0x764DBEAE7FA4F3A6ULL, 0x1E99B96E70A9BE8BULL, 0x2C5E9DEB57EF4743ULL, 0x3A938FEE32D29981ULL,
+    0x26E6DB8FFDF5ADFEULL, 0x469356C504EC9F9DULL, 0xC8763C5B08D1908CULL, 0x3F6C6AF859D80055ULL,
+    0x7F7CC39420A3A545ULL, 0x9BFB227EBDF4C5CEULL, 0x89039D79D6FC5C5CULL, 0x8FE88B57305E2AB6ULL,
+    0xA09E8C8C35AB96DEULL, 0xFA7E393983325753ULL, 0xD6B6D0ECC617C699ULL, 0xDFEA21EA9E7557E3ULL,
+    0xB67C1FA481680AF8ULL, 0xCA1E3785A9E724E5ULL, 0x1CFC8BED0D681639ULL, 0xD18D8549D140CAEAULL,
+    0x4ED0FE7E9DC91335ULL, 0xE4DBF0634473F5D2ULL, 0x1761F93A44D5AEFEULL, 0x53898E4C3910DA55ULL,
+    0x734DE8181F6EC39AULL, 0x2680B122BAA28D97ULL, 0x298AF231C85BAFABULL, 0x7983EED3740847D5ULL,
+    0x66C1A2A1A60CD889ULL, 0x9E17E49642A3E4C1ULL, 0xEDB454E7BADC0805ULL, 0x50B704CAB602C329ULL,
+    0x4CC317FB9CDDD023ULL, 0x66B4835D9EAFEA22ULL, 0x219B97E26FFC81BDULL, 0x261E4E4C0A333A9DULL,
+    0x1FE2CCA76517DB90ULL, 0xD7504DFA8816EDBBULL, 0xB9571FA04DC089C8ULL, 0x1DDC0325259B27DEULL,
+    0xCF3F4688801EB9AAULL, 0xF4F5D05C10CAB243ULL, 0x38B6525C21A42B0EULL, 0x36F60E2BA4FA6800ULL,
+    0xEB3593803173E0CEULL, 0x9C4CD6257C5A3603ULL, 0xAF0C317D32ADAA8AULL, 0x258E5A80C7204C4BULL,
+    0x8B889D624D44885DULL, 0xF4D14597E660F855ULL, 0xD4347F66EC8941C3ULL, 0xE699ED85B0DFB40DULL,
+    0x2472F6207C2D0484ULL, 0xC2A1E7B5B459AEB5ULL, 0xAB4F6451CC1D45ECULL, 0x63767572AE3D6174ULL,
+    0xA59E0BD101731A28ULL, 0x116D0016CB948F09ULL, 0x2CF9C8CA052F6E9FULL, 0x0B090A7560A968E3ULL,
+    0xABEEDDB2DDE06FF1ULL, 0x58EFC10B06A2068DULL, 0xC6E57A78FBD986E0ULL, 0x2EAB8CA63CE802D7ULL,
+    0x14A195640116F336ULL, 0x7C0828DD624EC390ULL, 0xD74BBE77E6116AC7ULL, 0x804456AF10F5FB53ULL,
+    0xEBE9EA2ADF4321C7ULL, 0x03219A39EE587A30ULL, 0x49787FEF17AF9924ULL, 0xA1E9300CD8520548ULL,
+    0x5B45E522E4B1B4EFULL, 0xB49C3B3995091A36ULL, 0xD4490AD526F14431ULL, 0x12A8F216AF9418C2ULL,
+    0x001F837CC7350524ULL, 0x1877B51E57A764D5ULL, 0xA2853B80F17F58EEULL, 0x993E1DE72D36D310ULL,
+    0xB3598080CE64A656ULL, 0x252F59CF0D9F04BBULL, 0xD23C8E176D113600ULL, 0x1BDA0492E7E4586EULL,
+    0x21E0BD5026C619BFULL, 0x3B097ADAF088F94EULL, 0x8D14DEDB30BE846EULL, 0xF95CFFA23AF5F6F4ULL,
+    0x3871700761B3F743ULL, 0xCA672B91E9E4FA16ULL, 0x64C8E531BFF53B55ULL, 0x241260ED4AD1E87DULL,
+    0x106C09B972D2E822ULL, 0x7FBA195410E5CA30ULL, 0x7884D9BC6CB569D8ULL, 0x0647DFEDCD894A29ULL,
+    0x63573FF03E224774ULL, 0x4FC8E9560F91B123ULL, 0x1DB956E450275779ULL, 0xB8D91274B9E9D4FBULL,
+    0xA2EBEE47E2FBFCE1ULL, 0xD9F1F30CCD97FB09ULL, 0xEFED53D75FD64E6BULL, 0x2E6D02C36017F67FULL,
+    0xA9AA4D20DB084E9BULL, 0xB64BE8D8B25396C1ULL, 0x70CB6AF7C2D5BCF0ULL, 0x98F076A4F7A2322EULL,
+    0xBF84470805E69B5FULL, 0x94C3251F06F90CF3ULL, 0x3E003E616A6591E9ULL, 0xB925A6CD0421AFF3ULL,
+    0x61BDD1307C66E300ULL, 0xBF8D5108E27E0D48ULL, 0x240AB57A8B888B20ULL, 0xFC87614BAF287E07ULL,
+    0xEF02CDD06FFDB432ULL, 0xA1082C0466DF6C0AULL, 0x8215E577001332C8ULL, 0xD39BB9C3A48DB6CFULL,
+    0x2738259634305C14ULL, 0x61CF4F94C97DF93DULL, 0x1B6BACA2AE4E125BULL, 0x758F450C88572E0BULL,
+    0x959F587D507A8359ULL, 0xB063E962E045F54DULL, 0x60E8ED72C0DFF5D1ULL, 0x7B64978555326F9FULL,
+    0xFD080D236DA814BAULL, 0x8C90FD9B083F4558ULL, 0x106F72FE81E2C590ULL, 0x7976033A39F7D952ULL,
+    0xA4EC0132764CA04BULL, 0x733EA705FAE4FA77ULL, 0xB4D8F77BC3E56167ULL, 0x9E21F4F903B33FD9ULL,
+    0x9D765E419FB69F6DULL, 0xD30C088BA61EA5EFULL, 0x5D94337FBFAF7F5BULL, 0x1A4E4822EB4D7A59ULL,
+    0x6FFE73E81B637FB3ULL, 0xDDF957BC36D8B9CAULL, 0x64D0E29EEA8838B3ULL, 0x08DD9BDFD96B9F63ULL,
+    0x087E79E5A57D1D13ULL, 0xE328E230E3E2B3FBULL, 0x1C2559E30F0946BEULL, 0x720BF5F26F4D2EAAULL,
+    0xB0774D261CC609DBULL, 0x443F64EC5A371195ULL, 0x4112CF68649A260EULL, 0xD813F2FAB7F5C5CAULL,
+    0x660D3257380841EEULL, 0x59AC2C7873F910A3ULL, 0xE846963877671A17ULL, 0x93B633ABFA3469F8ULL,
+    0xC0C0F5A60EF4CDCFULL, 0xCAF21ECD4377B28CULL, 0x57277707199B8175ULL, 0x506C11B9D90E8B1DULL,
+    0xD83CC2687A19255FULL, 0x4A29C6465A314CD1ULL, 0xED2DF21216235097ULL, 0xB5635C95FF7296E2ULL,
+    0x22AF003AB672E811ULL, 0x52E762596BF68235ULL, 0x9AEBA33AC6ECC6B0ULL, 0x944F6DE09134DFB6ULL,
+    0x6C47BEC883A7DE39ULL, 0x6AD047C430A12104ULL, 0xA5B1CFDBA0AB4067ULL, 0x7C45D833AFF07862ULL,
+    0x5092EF950A16DA0BULL, 0x9338E69C052B8E7BULL, 0x455A4B4CFE30E3F5ULL, 0x6B02E63195AD0CF8ULL,
+    0x6B17B224BAD6BF27ULL, 0xD1E0CCD25BB9C169ULL, 0xDE0C89A556B9AE70ULL, 0x50065E535A213CF6ULL,
+    0x9C1169FA2777B874ULL, 0x78EDEFD694AF1EEDULL, 0x6DC93D9526A50E68ULL, 0xEE97F453F06791EDULL,
+    0x32AB0EDB696703D3ULL, 0x3A6853C7E70757A7ULL, 0x31865CED6120F37DULL, 0x67FEF95D92607890ULL,
+    0x1F2B1D1F15F6DC9CULL, 0xB69E38A8965C6B65ULL, 0xAA9119FF184CCCF4ULL, 0xF43C732873F24C13ULL,
+    0xFB4A3D794A9A80D2ULL, 0x3550C2321FD6109CULL, 0x371F77E76BB8417EULL, 0x6BFA9AAE5EC05779ULL,
+    0xCD04F3FF001A4778ULL, 0xE3273522064480CAULL, 0x9F91508BFFCFC14AULL, 0x049A7F41061A9E60ULL,
+    0xFCB6BE43A9F2FE9BULL, 0x08DE8A1C7797DA9BULL, 0x8F9887E6078735A1ULL, 0xB5B4071DBFC73A66ULL,
+    0x230E343DFBA08D33ULL, 0x43ED7F5A0FAE657DULL, 0x3A88A0FBBCB05C63ULL, 0x21874B8B4D2DBC4FULL,
+    0x1BDEA12E35F6A8C9ULL, 0x53C065C6C8E63528ULL, 0xE34A1D250E7A8D6BULL, 0xD6B04D3B7651DD7EULL,
+    0x5E90277E7CB39E2DULL, 0x2C046F22062DC67DULL, 0xB10BB459132D0A26ULL, 0x3FA9DDFB67E2F199ULL,
+    0x0E09B88E1914F7AFULL, 0x10E8B35AF3EEAB37ULL, 0x9EEDECA8E272B933ULL, 0xD4C718BC4AE8AE5FULL,
+    0x81536D601170FC20ULL, 0x91B534F885818A06ULL, 0xEC8177F83F900978ULL, 0x190E714FADA5156EULL,
+    0xB592BF39B0364963ULL, 0x89C350C893AE7DC1ULL, 0xAC042E70F8B383F2ULL, 0xB49B52E587A1EE60ULL,
+    0xFB152FE3FF26DA89ULL, 0x3E666E6F69AE2C15ULL, 0x3B544EBE544C19F9ULL, 0xE805A1E290CF2456ULL,
+    0x24B33C9D7ED25117ULL, 0xE74733427B72F0C1ULL, 0x0A804D18B7097475ULL, 0x57E3306D881EDB4FULL,
+    0x4AE7D6A36EB5DBCBULL, 0x2D8D5432157064C8ULL, 0xD1E649DE1E7F268BULL, 0x8A328A1CEDFE552CULL,
+    0x07A3AEC79624C7DAULL, 0x84547DDC3E203C94ULL, 0x990A98FD5071D263ULL, 0x1A4FF12616EEFC89ULL,
+    0xF6F7FD1431714200ULL, 0x30C05B1BA332F41CULL, 0x8D2636B81555A786ULL, 0x46C9FEB55D120902ULL,
+    0xCCEC0A73B49C9921ULL, 0x4E9D2827355FC492ULL, 0x19EBB029435DCB0FULL, 0x4659D2B743848A2CULL,
+    0x963EF2C96B33BE31ULL, 0x74F85198B05A2E7DULL, 0x5A0F544DD2B1FB18ULL, 0x03727073C2E134B1ULL,
+    0xC7F6AA2DE59AEA61ULL, 0x352787BAA0D7C22FULL, 0x9853EAB63B5E0B35ULL, 0xABBDCDD7ED5C0860ULL,
+    0xCF05DAF5AC8D77B0ULL, 0x49CAD48CEBF4A71EULL, 0x7A4C10EC2158C4A6ULL, 0xD9E92AA246BF719EULL,
+    0x13AE978D09FE5557ULL, 0x730499AF921549FFULL, 0x4E4B705B92903BA4ULL, 0xFF577222C14F0A3AULL,
+    0x55B6344CF97AAFAEULL, 0xB862225B055B6960ULL, 0xCAC09AFBDDD2CDB4ULL, 0xDAF8E9829FE96B5FULL,
+    0xB5FDFC5D3132C498ULL, 0x310CB380DB6F7503ULL, 0xE87FBB46217A360EULL, 0x2102AE466EBB1148ULL,
+    0xF8549E1A3AA5E00DULL, 0x07A69AFDCC42261AULL, 0xC4C118BFE78FEAAEULL, 0xF9F4892ED96BD438ULL,
+    0x1AF3DBE25D8F45DAULL, 0xF5B4B0B0D2DEEEB4ULL, 0x962ACEEFA82E1C84ULL, 0x046E3ECAAF453CE9ULL,
+    0xF05D129681949A4CULL, 0x964781CE734B3C84ULL, 0x9C2ED44081CE5FBDULL, 0x522E23F3925E319EULL,
+    0x177E00F9FC32F791ULL, 0x2BC60A63A6F3B3F2ULL, 0x222BBFAE61725606ULL, 0x486289DDCC3D6780ULL,
+    0x7DC7785B8EFDFC80ULL, 0x8AF38731C02BA980ULL, 0x1FAB64EA29A2DDF7ULL, 0xE4D9429322CD065AULL,
+    0x9DA058C67844F20CULL, 0x24C0E332B70019B0ULL, 0x233003B5A6CFE6ADULL, 0xD586BD01C5C217F6ULL,
+    0x5E5637885F29BC2BULL, 0x7EBA726D8C94094BULL, 0x0A56A5F0BFE39272ULL, 0xD79476A84EE20D06ULL,
+    0x9E4C1269BAA4BF37ULL, 0x17EFEE45B0DEE640ULL, 0x1D95B0A5FCF90BC6ULL, 0x93CBE0B699C2585DULL,
+    0x65FA4F227A2B6D79ULL, 0xD5F9E858292504D5ULL, 0xC2B5A03F71471A6FULL, 0x59300222B4561E00ULL,
+    0xCE2F8642CA0712DCULL, 0x7CA9723FBB2E8988ULL, 0x2785338347F2BA08ULL, 0xC61BB3A141E50E8CULL,
+    0x150F361DAB9DEC26ULL, 0x9F6A419D382595F4ULL, 0x64A53DC924FE7AC9ULL, 0x142DE49FFF7A7C3DULL,
+    0x0C335248857FA9E7ULL, 0x0A9C32D5EAE45305ULL, 0xE6C42178C4BBB92EULL, 0x71F1CE2490D20B07ULL,
+    0xF1BCC3D275AFE51AULL, 0xE728E8C83C334074ULL, 0x96FBF83A12884624ULL, 0x81A1549FD6573DA5ULL,
+    0x5FA7867CAF35E149ULL, 0x56986E2EF3ED091BULL, 0x917F1DD5F8886C61ULL, 0xD20D8C88C8FFE65FULL,
+    0x31D71DCE64B2C310ULL, 0xF165B587DF898190ULL, 0xA57E6339DD2CF3A0ULL, 0x1EF6E6DBB1961EC9ULL,
+    0x70CC73D90BC26E24ULL, 0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL, 0x1C99DED33CB890A1ULL,
+    0xCF3145DE0ADD4289ULL, 0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL, 0x67A34DAC4356550BULL,
+    0xF8D626AAAF278509ULL
+}};
+
+// Polyglot piece kind: black pawn 0, white pawn 1, black knight 2, ... white king 11
+int zobristPieceKind(char symbol) {
+    int kind = 0;
+    switch (toupper(symbol)) {
+        case 'P': kind = 0; break;
+        case 'N': kind = 1; break;
+        case 'B': kind = 2; break;
+        case 'R': kind = 3; break;
+        case 'Q': kind = 4; break;
+        case 'K': kind = 5; break;
+    }
+    return kind * 2 + (isupper(symbol) ? 1 : 0);
+}
+
+// Piece-square tables from White's side, a8 first (row 0 of our board).
+// Indexed by piece type in Polyglot order: pawn, knight, bishop, rook, queen, king.
+const int MIDGAME_VALUE[6] = {82, 337, 365, 477, 1025, 0};
+const int ENDGAME_VALUE[6] = {94, 281, 297, 512, 936, 0};
+const int PHASE_WEIGHT[6] = {0, 1, 1, 2, 4, 0};
+const int MAX_PHASE = 24;
+
+const int PAWN_MIDGAME[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+const int PAWN_ENDGAME[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    80, 80, 80, 80, 80, 80, 80, 80,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    30, 30, 30, 30, 30, 30, 30, 30,
+    15, 15, 15, 15, 15, 15, 15, 15,
+     5,  5,  5,  5,  5,  5,  5,  5,
+     0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+const int KNIGHT_TABLE[64] = {
+   -50,-40,-30,-30,-30,-30,-40,-50,
+   -40,-20,  0,  0,  0,  0,-20,-40,
+   -30,  0, 10, 15, 15, 10,  0,-30,
+   -30,  5, 15, 20, 20, 15,  5,-30,
+   -30,  0, 15, 20, 20, 15,  0,-30,
+   -30,  5, 10, 15, 15, 10,  5,-30,
+   -40,-20,  0,  5,  5,  0,-20,-40,
+   -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+const int BISHOP_TABLE[64] = {
+   -20,-10,-10,-10,-10,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5, 10, 10,  5,  0,-10,
+   -10,  5,  5, 10, 10,  5,  5,-10,
+   -10,  0, 10, 10, 10, 10,  0,-10,
+   -10, 10, 10, 10, 10, 10, 10,-10,
+   -10,  5,  0,  0,  0,  0,  5,-10,
+   -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+const int ROOK_TABLE[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0
+};
+
+const int QUEEN_TABLE[64] = {
+   -20,-10,-10, -5, -5,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5,  5,  5,  5,  0,-10,
+    -5,  0,  5,  5,  5,  5,  0, -5,
+     0,  0,  5,  5,  5,  5,  0, -5,
+   -10,  5,  5,  5,  5,  5,  0,-10,
+   -10,  0,  5,  0,  0,  0,  0,-10,
+   -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+const int KING_MIDGAME[64] = {
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -20,-30,-30,-40,-40,-30,-30,-20,
+   -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20
+};
+
+const int KING_ENDGAME[64] = {
+   -50,-40,-30,-20,-20,-30,-40,-50,
+   -30,-20,-10,  0,  0,-10,-20,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-30,  0,  0,  0,  0,-30,-30,
+   -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+// Pawn-structure terms, indexed by relative rank where needed (1 = starting rank)
+const int PASSED_PAWN_MIDGAME[8] = {0, 5, 10, 15, 30, 50, 90, 0};
+const int PASSED_PAWN_ENDGAME[8] = {0, 10, 15, 25, 45, 80, 140, 0};
+const int ISOLATED_PAWN_MIDGAME = 10;
+const int ISOLATED_PAWN_ENDGAME = 15;
+const int DOUBLED_PAWN_MIDGAME = 10;
+const int DOUBLED_PAWN_ENDGAME = 20;
+const int BACKWARD_PAWN_MIDGAME = 8;
+const int BACKWARD_PAWN_ENDGAME = 10;
+
+// Piece values for static exchange evaluation; the king outweighs any exchange
+int exchangeValue(char symbol) {
+    switch (toupper(symbol)) {
+        case 'P': return 100;
+        case 'N': return 320;
+        case 'B': return 330;
+        case 'R': return 500;
+        case 'Q': return 900;
+        case 'K': return 20000;
+        default: return 0;
+    }
+}
+
+// Square (x * 8 + y) of the cheapest piece of one colour attacking target, -1 if none.
+// squares holds piece symbols, 0 for empty; pieces already exchanged are removed,
+// which uncovers sliders behind them
+int leastValuableAttacker(const char squares[64], int target, bool white) {
+    int tx = target / 8;
+    int ty = target % 8;
+    int best = -1;
+    int bestValue = 0;
+    auto consider = [&](int x, int y, const char* symbols) {
+        if (x < 0 || x > 7 || y < 0 || y > 7) return;
+        char symbol = squares[x * 8 + y];
+        if (symbol && strchr(symbols, symbol) && (best == -1 || exchangeValue(symbol) < bestValue)) {
+            best = x * 8 + y;
+            bestValue = exchangeValue(symbol);
+        }
+    };
+    
+    // White pawns capture towards row 0, so they attack from the row below
+    int pawnRow = white ? tx + 1 : tx - 1;
+    consider(pawnRow, ty - 1, white ? "P" : "p");
+    consider(pawnRow, ty + 1, white ? "P" : "p");
+    
+    const int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+    for (const auto& step : knightSteps) {
+        consider(tx + step[0], ty + step[1], white ? "N" : "n");
+    }
+    
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            if (dx == 0 && dy == 0) continue;
+            consider(tx + dx, ty + dy, white ? "K" : "k");
+            
+            // First piece along the ray
+            bool diagonal = dx != 0 && dy != 0;
+            const char* sliders = diagonal ? (white ? "BQ" : "bq") : (white ? "RQ" : "rq");
+            int x = tx + dx;
+            int y = ty + dy;
+            while (x >= 0 && x < 8 && y >= 0 && y < 8 && !squares[x * 8 + y]) {
+                x += dx;
+                y += dy;
+            }
+            consider(x, y, sliders);
+        }
+    }
+    return best;
+}
+
+// Signed material plus square bonus per Polyglot piece kind and board square
+// (x * 8 + y); black pieces read the White tables mirrored
+struct PieceSquareScores {
+    int midgame[12][64];
+    int endgame[12][64];
+};
+
+const PieceSquareScores& pieceSquareScores() {
+    static PieceSquareScores scores = [] {
+        const int* midgameTables[6] = {PAWN_MIDGAME, KNIGHT_TABLE, BISHOP_TABLE, ROOK_TABLE, QUEEN_TABLE, KING_MIDGAME};
+        const int* endgameTables[6] = {PAWN_ENDGAME, KNIGHT_TABLE, BISHOP_TABLE, ROOK_TABLE, QUEEN_TABLE, KING_ENDGAME};
+        PieceSquareScores result;
+        for (int kind = 0; kind < 12; ++kind) {
+            int type = kind / 2;
+            bool white = (kind & 1) != 0;
+            for (int sq = 0; sq < 64; ++sq) {
+                int tableSquare = white ? sq : (7 - sq / 8) * 8 + sq % 8;
+                int sign = white ? 1 : -1;
+                result.midgame[kind][sq] = sign * (MIDGAME_VALUE[type] + midgameTables[type][tableSquare]);
+                result.endgame[kind][sq] = sign * (ENDGAME_VALUE[type] + endgameTables[type][tableSquare]);
+            }
+        }
+        return result;
+    }();
+    return scores;
+}
+
+} // namespace
+
+Board::Board() : gameOver(false), gameStatus("ongoing"), enPassantTarget(-1, -1),
+                 midgameScore(0), endgameScore(0), gamePhase(0), pieceKey(0), pawnKey(0),
+                 halfmoveClock(0), network(nullptr) {
+    for (auto &row : board) {
+        row.fill(nullptr);
+    }
     resetBoard();
 }
 
 Board::Board(const Board& other) : gameOver(other.gameOver), gameStatus(other.gameStatus), 
-                                   movedPieces(other.movedPieces), enPassantTarget(other.enPassantTarget) {
+                                   movedPieces(other.movedPieces), enPassantTarget(other.enPassantTarget),
+                                   midgameScore(other.midgameScore), endgameScore(other.endgameScore),
+                                   gamePhase(other.gamePhase), pieceKey(other.pieceKey), pawnKey(other.pawnKey),
+                                   halfmoveClock(other.halfmoveClock), keyHistory(other.keyHistory),
+                                   network(other.network) {
+    if (network) {
+        accumulator = other.accumulator;
+    }
+    
     // Initialize board with nullptr
     for (auto &row : board) {
         row.fill(nullptr);
@@ -62,6 +493,17 @@ Board& Board::operator=(const Board& other) {
         gameStatus = other.gameStatus;
         movedPieces = other.movedPieces;
         enPassantTarget = other.enPassantTarget;
+        midgameScore = other.midgameScore;
+        endgameScore = other.endgameScore;
+        gamePhase = other.gamePhase;
+        pieceKey = other.pieceKey;
+        pawnKey = other.pawnKey;
+        halfmoveClock = other.halfmoveClock;
+        keyHistory = other.keyHistory;
+        network = other.network;
+        if (network) {
+            accumulator = other.accumulator;
+        }
     }
     return *this;
 }
@@ -91,31 +533,255 @@ Piece* Board::createPieceCopy(Piece* original) const {
 }
 
 void Board::resetBoard() {
+    clearBoard();
+    setupPieces();
+    gameOver = false;
+    gameStatus = "ongoing";
+    halfmoveClock = 0;
+    keyHistory.assign(1, getZobristKey(true));
+}
+
+void Board::clearBoard() {
     for (auto &row : board) {
-        row.fill(nullptr); // Initialize all squares to nullptr
+        for (auto &piece : row) {
+            delete piece;
+            piece = nullptr;
+        }
     }
-    setupPieces();
+    resetTerms();
+}
+
+void Board::resetTerms() {
+    movedPieces.clear();
+    enPassantTarget = {-1, -1};
+    midgameScore = 0;
+    endgameScore = 0;
+    gamePhase = 0;
+    pieceKey = 0;
+    pawnKey = 0;
+    if (network) {
+        network->resetAccumulator(accumulator);
+    }
+}
+
+bool Board::loadFEN(const std::string& fen, bool& whiteToMove, int& fullmoveNumber) {
+    // One pass over the record into locals; the board is only touched once all of it checks out
+    const char* p = fen.c_str();
+    const char* end = p + fen.size();
+    auto skipSpaces = [&]() {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    };
+    auto atFieldEnd = [&]() { return p == end || *p == ' ' || *p == '\t'; };
+    
+    // Piece placement, rank 8 first
+    skipSpaces();
+    char squares[64] = {};
+    int row = 0, col = 0;
+    int kings[2] = {0, 0}; // Black, white
+    int kingSquares[2] = {-1, -1};
+    for (; !atFieldEnd(); ++p) {
+        char c = *p;
+        if (c == '/') {
+            if (col != 8 || ++row > 7) return false;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+            if (col > 8) return false;
+        } else if (col < 8 && strchr("PNBRQKpnbrqk", c)) {
+            bool white = c < 'a';
+            if ((c == 'P' || c == 'p') && (row == 0 || row == 7)) return false;
+            if (c == 'K' || c == 'k') {
+                kings[white]++;
+                kingSquares[white] = row * 8 + col;
+            }
+            squares[row * 8 + col++] = c;
+        } else {
+            return false;
+        }
+    }
+    if (row != 7 || col != 8 || kings[0] != 1 || kings[1] != 1) {
+        return false;
+    }
+    
+    // Side to move
+    skipSpaces();
+    if (p == end || (*p != 'w' && *p != 'b')) return false;
+    bool white = *p++ == 'w';
+    if (!atFieldEnd()) return false;
+    
+    // The side that just moved cannot be in check
+    if (leastValuableAttacker(squares, kingSquares[!white], white) != -1) {
+        return false;
+    }
+    
+    // Castling rights; missing fields default to none, no en passant and zero clocks
+    bool rights[4] = {false, false, false, false}; // K, Q, k, q
+    skipSpaces();
+    if (p < end && *p == '-') {
+        ++p;
+    } else {
+        const char* const letters = "KQkq";
+        for (; !atFieldEnd(); ++p) {
+            const char* right = *p ? strchr(letters, *p) : nullptr;
+            if (!right) return false;
+            rights[right - letters] = true;
+        }
+    }
+    if (!atFieldEnd()) return false;
+    
+    // En passant target: on the sixth rank from the mover's side, behind the pawn that just advanced
+    int epX = -1, epY = -1;
+    skipSpaces();
+    if (p < end && *p == '-') {
+        ++p;
+    } else if (p < end) {
+        if (end - p < 2 || p[0] < 'a' || p[0] > 'h' || p[1] != (white ? '6' : '3')) return false;
+        epX = white ? 2 : 5;
+        epY = p[0] - 'a';
+        int pawnX = white ? 3 : 4;
+        int startX = white ? 1 : 6;
+        if (squares[pawnX * 8 + epY] != (white ? 'p' : 'P') || squares[epX * 8 + epY] || squares[startX * 8 + epY]) {
+            return false;
+        }
+        p += 2;
+    }
+    if (!atFieldEnd()) return false;
+    
+    // Halfmove clock and fullmove number
+    int clocks[2] = {0, 1};
+    for (int field = 0; field < 2; ++field) {
+        skipSpaces();
+        if (p == end) break;
+        int value = 0;
+        const char* start = p;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (value > 100000000) return false;
+            value = value * 10 + (*p - '0');
+        }
+        if (p == start || !atFieldEnd()) return false;
+        clocks[field] = value;
+    }
+    skipSpaces();
+    if (p != end) {
+        return false;
+    }
+    
+    // Set up the board, keeping piece objects that are already on the right square
+    resetTerms();
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            Piece* piece = board[i][j];
+            char symbol = squares[i * 8 + j];
+            board[i][j] = nullptr;
+            if (piece && piece->getSymbol() == symbol) {
+                placePiece(i, j, piece);
+                continue;
+            }
+            delete piece;
+            if (!symbol) continue;
+            bool isWhite = symbol < 'a';
+            switch (toupper(symbol)) {
+                case 'P': placePiece(i, j, new Pawn(isWhite)); break;
+                case 'N': placePiece(i, j, new Knight(isWhite)); break;
+                case 'B': placePiece(i, j, new Bishop(isWhite)); break;
+                case 'R': placePiece(i, j, new Rook(isWhite)); break;
+                case 'Q': placePiece(i, j, new Queen(isWhite)); break;
+                case 'K': placePiece(i, j, new King(isWhite)); break;
+            }
+        }
+    }
+    
+    // Castling rights are tracked as unmoved king and rook squares; mark every
+    // right that is not granted, or whose pieces are not at home, as moved
+    for (int right = 0; right < 4; ++right) {
+        bool whiteRight = right < 2;
+        int homeRow = whiteRight ? 7 : 0;
+        int rookCol = right % 2 == 0 ? 7 : 0;
+        bool available = rights[right] && squares[homeRow * 8 + 4] == (whiteRight ? 'K' : 'k') &&
+                         squares[homeRow * 8 + rookCol] == (whiteRight ? 'R' : 'r');
+        if (!available) {
+            recordPieceMovement(homeRow, rookCol);
+        }
+    }
+    for (int homeRow = 0; homeRow <= 7; homeRow += 7) {
+        if (hasRookMoved(homeRow == 7, true) && hasRookMoved(homeRow == 7, false)) {
+            recordPieceMovement(homeRow, 4);
+        }
+    }
+    if (epX != -1) {
+        setEnPassantTarget(epX, epY);
+    }
+    
+    whiteToMove = white;
+    fullmoveNumber = std::max(clocks[1], 1);
     gameOver = false;
     gameStatus = "ongoing";
+    halfmoveClock = clocks[0];
+    keyHistory.assign(1, getZobristKey(whiteToMove));
+    return true;
 }
 
 void Board::setupPieces() {
     for (int i = 0; i < 8; ++i) {
-        board[6][i] = new Pawn(true);  // White Pawns (row 6)
-        board[1][i] = new Pawn(false); // Black Pawns (row 1)
+        placePiece(6, i, new Pawn(true));  // White Pawns (row 6)
+        placePiece(1, i, new Pawn(false)); // Black Pawns (row 1)
     }
 
-    board[7][0] = new Rook(true); board[7][7] = new Rook(true);
-    board[0][0] = new Rook(false); board[0][7] = new Rook(false);
+    placePiece(7, 0, new Rook(true)); placePiece(7, 7, new Rook(true));
+    placePiece(0, 0, new Rook(false)); placePiece(0, 7, new Rook(false));
 
-    board[7][1] = new Knight(true); board[7][6] = new Knight(true);
-    board[0][1] = new Knight(false); board[0][6] = new Knight(false);
+    placePiece(7, 1, new Knight(true)); placePiece(7, 6, new Knight(true));
+    placePiece(0, 1, new Knight(false)); placePiece(0, 6, new Knight(false));
 
-    board[7][2] = new Bishop(true); board[7][5] = new Bishop(true);
-    board[0][2] = new Bishop(false); board[0][5] = new Bishop(false);
+    placePiece(7, 2, new Bishop(true)); placePiece(7, 5, new Bishop(true));
+    placePiece(0, 2, new Bishop(false)); placePiece(0, 5, new Bishop(false));
 
-    board[7][3] = new Queen(true); board[7][4] = new King(true);
-    board[0][3] = new Queen(false); board[0][4] = new King(false);
+    placePiece(7, 3, new Queen(true)); placePiece(7, 4, new King(true));
+    placePiece(0, 3, new Queen(false)); placePiece(0, 4, new King(false));
+}
+
+void Board::placePiece(int x, int y, Piece* piece) {
+    board[x][y] = piece;
+    if (piece) {
+        int kind = zobristPieceKind(piece->getSymbol());
+        const auto& scores = pieceSquareScores();
+        midgameScore += scores.midgame[kind][x * 8 + y];
+        endgameScore += scores.endgame[kind][x * 8 + y];
+        gamePhase += PHASE_WEIGHT[kind / 2];
+        uint64_t squareKey = ZOBRIST_RANDOM[64 * kind + 8 * (7 - x) + y];
+        pieceKey ^= squareKey;
+        if (kind < 2) {
+            pawnKey ^= squareKey;
+        }
+        if (network) {
+            network->addPiece(accumulator, piece->getSymbol(), x, y);
+        }
+    }
+}
+
+Piece* Board::liftPiece(int x, int y) {
+    Piece* piece = board[x][y];
+    if (piece) {
+        int kind = zobristPieceKind(piece->getSymbol());
+        const auto& scores = pieceSquareScores();
+        midgameScore -= scores.midgame[kind][x * 8 + y];
+        endgameScore -= scores.endgame[kind][x * 8 + y];
+        gamePhase -= PHASE_WEIGHT[kind / 2];
+        uint64_t squareKey = ZOBRIST_RANDOM[64 * kind + 8 * (7 - x) + y];
+        pieceKey ^= squareKey;
+        if (kind < 2) {
+            pawnKey ^= squareKey;
+        }
+        if (network) {
+            network->removePiece(accumulator, piece->getSymbol(), x, y);
+        }
+        board[x][y] = nullptr;
+    }
+    return piece;
+}
+
+void Board::capturePiece(int x, int y) {
+    delete liftPiece(x, y);
 }
 
 void Board::printBoard() const {
@@ -157,6 +823,48 @@ Piece* Board::getPiece(int x, int y) const {
 }
 
 void Board::movePiece(int x1, int y1, int x2, int y2) {
+    Piece* mover = board[x1][y1];
+    if (!mover) {
+        applyMove(x1, y1, x2, y2);
+        return;
+    }
+    
+    // Captures and pawn moves can never be undone, so no earlier position can repeat
+    bool moverIsWhite = mover->isWhite();
+    bool irreversible = toupper(mover->getSymbol()) == 'P' || board[x2][y2] != nullptr;
+    applyMove(x1, y1, x2, y2);
+    if (irreversible) {
+        halfmoveClock = 0;
+        keyHistory.clear();
+    } else {
+        halfmoveClock++;
+    }
+    keyHistory.push_back(getZobristKey(!moverIsWhite));
+}
+
+bool Board::isRepetition() const {
+    // Only positions with the same side to move, at least four plies back, can match
+    uint64_t current = keyHistory.back();
+    for (int i = static_cast<int>(keyHistory.size()) - 5; i >= 0; i -= 2) {
+        if (keyHistory[i] == current) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Board::countRepetitions() const {
+    uint64_t current = keyHistory.back();
+    int count = 0;
+    for (int i = static_cast<int>(keyHistory.size()) - 1; i >= 0; i -= 2) {
+        if (keyHistory[i] == current) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void Board::applyMove(int x1, int y1, int x2, int y2) {
     // Handle en passant
     if (board[x1][y1] && board[x1][y1]->getSymbol() == (board[x1][y1]->isWhite() ? 'P' : 'p')) {
         Pawn* pawn = dynamic_cast<Pawn*>(board[x1][y1]);
@@ -188,21 +896,20 @@ void Board::movePiece(int x1, int y1, int x2, int y2) {
     // Record that the piece has moved (for regular moves)
     recordPieceMovement(x1, y1);
     
+    capturePiece(x2, y2);
+    
     // Handle pawn promotion
     if (board[x1][y1] && board[x1][y1]->getSymbol() == 'P' && x2 == 0) {
         // White pawn reaching the top (row 0)
-        delete board[x1][y1];
-        board[x2][y2] = new Queen(true);
-        board[x1][y1] = nullptr;
+        capturePiece(x1, y1);
+        placePiece(x2, y2, new Queen(true));
     } else if (board[x1][y1] && board[x1][y1]->getSymbol() == 'p' && x2 == 7) {
         // Black pawn reaching the bottom (row 7)
-        delete board[x1][y1];
-        board[x2][y2] = new Queen(false);
-        board[x1][y1] = nullptr;
+        capturePiece(x1, y1);
+        placePiece(x2, y2, new Queen(false));
     } else {
         // Regular move
-        board[x2][y2] = board[x1][y1];
-        board[x1][y1] = nullptr;
+        placePiece(x2, y2, liftPiece(x1, y1));
     }
 }
 
@@ -222,7 +929,13 @@ bool Board::isSquareUnderAttack(int x, int y, bool byWhite) const {
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
             if (board[i][j] && board[i][j]->isWhite() == byWhite) {
-                if (board[i][j]->isValidMove(i, j, x, y, *this)) {
+                // A king attacks its neighbours even when they are defended; asking
+                // King::isValidMove would recurse between the two kings forever
+                if (toupper(board[i][j]->getSymbol()) == 'K') {
+                    if (abs(i - x) <= 1 && abs(j - y) <= 1 && (i != x || j != y)) {
+                        return true;
+                    }
+                } else if (board[i][j]->isValidMove(i, j, x, y, *this)) {
                     return true;
                 }
             }
@@ -242,8 +955,8 @@ bool Board::canMoveWithoutLeavingCheck(int x1, int y1, int x2, int y2, bool isWh
     Board tempBoard = *this;
     
     // Make the move on temporary board
-    tempBoard.board[x2][y2] = tempBoard.board[x1][y1];
-    tempBoard.board[x1][y1] = nullptr;
+    tempBoard.capturePiece(x2, y2);
+    tempBoard.placePiece(x2, y2, tempBoard.liftPiece(x1, y1));
     
     // Check if the king is still in check after the move
     return !tempBoard.isCheck(isWhiteKing);
@@ -289,6 +1002,104 @@ std::vector<std::pair<int, int>> Board::getLegalMoves(int x, int y) const {
     return legalMoves;
 }
 
+bool Board::isCaptureMove(int x1, int y1, int x2, int y2) const {
+    if (board[x2][y2]) {
+        return true;
+    }
+    Piece* piece = board[x1][y1];
+    return piece && toupper(piece->getSymbol()) == 'P' && y1 != y2;
+}
+
+int Board::getCandidateTargets(int x, int y, std::pair<int, int>* targets) const {
+    Piece* piece = board[x][y];
+    char type = static_cast<char>(toupper(piece->getSymbol()));
+    int count = 0;
+    auto add = [&](int i, int j) {
+        if (i >= 0 && i < 8 && j >= 0 && j < 8) {
+            targets[count++] = {i, j};
+        }
+    };
+    
+    if (type == 'P') {
+        int direction = piece->isWhite() ? -1 : 1;
+        add(x + direction, y);
+        add(x + 2 * direction, y);
+        add(x + direction, y - 1);
+        add(x + direction, y + 1);
+    } else if (type == 'N') {
+        const int steps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+        for (const auto& step : steps) {
+            add(x + step[0], y + step[1]);
+        }
+    } else if (type == 'K') {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (dx != 0 || dy != 0) add(x + dx, y + dy);
+            }
+        }
+        add(x, y - 2); // Castling
+        add(x, y + 2);
+    } else {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (dx == 0 && dy == 0) continue;
+                bool diagonal = dx != 0 && dy != 0;
+                if ((type == 'R' && diagonal) || (type == 'B' && !diagonal)) continue;
+                for (int i = x + dx, j = y + dy; i >= 0 && i < 8 && j >= 0 && j < 8; i += dx, j += dy) {
+                    add(i, j);
+                    if (board[i][j]) break;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+void Board::generatePieceMoves(int x, int y, bool captures, bool quiets,
+                               std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const {
+    // isValidMove settles which candidate squares the piece can really move to
+    std::pair<int, int> targets[MAX_TARGETS];
+    int count = getCandidateTargets(x, y, targets);
+    for (int k = 0; k < count; ++k) {
+        int i = targets[k].first;
+        int j = targets[k].second;
+        bool capture = isCaptureMove(x, y, i, j);
+        if ((capture ? captures : quiets) && isValidMove(x, y, i, j)) {
+            moves.push_back({{x, y}, {i, j}});
+        }
+    }
+}
+
+void Board::generateMoves(bool forWhite, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const {
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            if (board[i][j] && board[i][j]->isWhite() == forWhite) {
+                generatePieceMoves(i, j, true, true, moves);
+            }
+        }
+    }
+}
+
+void Board::generateCaptures(bool forWhite, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const {
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            if (board[i][j] && board[i][j]->isWhite() == forWhite) {
+                generatePieceMoves(i, j, true, false, moves);
+            }
+        }
+    }
+}
+
+void Board::generateQuietMoves(bool forWhite, std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& moves) const {
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            if (board[i][j] && board[i][j]->isWhite() == forWhite) {
+                generatePieceMoves(i, j, false, true, moves);
+            }
+        }
+    }
+}
+
 bool Board::hasLegalMoves(bool isWhiteKing) const {
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
@@ -314,23 +1125,23 @@ void Board::promotePawn(int x, int y, char pieceType) {
     if (!board[x][y]) return;
     
     bool isWhite = board[x][y]->isWhite();
-    delete board[x][y];
+    capturePiece(x, y);
     
     switch (pieceType) {
         case 'Q': case 'q':
-            board[x][y] = new Queen(isWhite);
+            placePiece(x, y, new Queen(isWhite));
             break;
         case 'R': case 'r':
-            board[x][y] = new Rook(isWhite);
+            placePiece(x, y, new Rook(isWhite));
             break;
         case 'B': case 'b':
-            board[x][y] = new Bishop(isWhite);
+            placePiece(x, y, new Bishop(isWhite));
             break;
         case 'N': case 'n':
-            board[x][y] = new Knight(isWhite);
+            placePiece(x, y, new Knight(isWhite));
             break;
         default:
-            board[x][y] = new Queen(isWhite); // Default to queen
+            placePiece(x, y, new Queen(isWhite)); // Default to queen
     }
 }
 
@@ -394,13 +1205,11 @@ bool Board::performCastling(bool isWhiteKing, bool isKingSide) {
     
     // Move king
     int kingDestY = isKingSide ? 6 : 2;
-    board[kingX][kingDestY] = board[kingX][kingY];
-    board[kingX][kingY] = nullptr;
+    placePiece(kingX, kingDestY, liftPiece(kingX, kingY));
     
     // Move rook
     int rookDestY = isKingSide ? 5 : 3;
-    board[kingX][rookDestY] = board[kingX][rookY];
-    board[kingX][rookY] = nullptr;
+    placePiece(kingX, rookDestY, liftPiece(kingX, rookY));
     
     // Record movements
     recordPieceMovement(kingX, kingY);
@@ -448,12 +1257,10 @@ bool Board::performEnPassant(int x1, int y1, int x2, int y2) {
     }
     
     // Move the pawn
-    board[x2][y2] = board[x1][y1];
-    board[x1][y1] = nullptr;
+    placePiece(x2, y2, liftPiece(x1, y1));
     
     // Remove the captured pawn
-    delete board[x1][y2];
-    board[x1][y2] = nullptr;
+    capturePiece(x1, y2);
     
     // Clear en passant target
     clearEnPassantTarget();
@@ -477,33 +1284,479 @@ void Board::recordPieceMovement(int x, int y) {
     movedPieces.insert({x, y});
 }
 
+void Board::setNetwork(const NnueNetwork* evaluator) {
+    network = evaluator;
+    if (!network) {
+        return;
+    }
+    
+    // Rebuild the accumulator from scratch; moves keep it current from here on
+    network->resetAccumulator(accumulator);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            if (board[i][j]) {
+                network->addPiece(accumulator, board[i][j]->getSymbol(), i, j);
+            }
+        }
+    }
+}
+
 int Board::evaluatePosition() const {
-    int score = 0;
+    if (network) {
+        return network->evaluate(accumulator);
+    }
+    
+    return taperScore(midgameScore, endgameScore);
+}
+
+int Board::taperScore(int midgame, int endgame) const {
+    // Blend the two scores by how much material is left; promotions can push
+    // the phase past its starting value
+    int phase = std::min(gamePhase, MAX_PHASE);
+    return (midgame * phase + endgame * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+CheckInfo Board::getCheckInfo(bool forWhite) const {
+    CheckInfo info;
+    info.discoverers = 0;
+    for (auto& squares : info.checkSquares) {
+        squares = 0;
+    }
+    
+    auto king = findKing(!forWhite);
+    info.kingSquare = king.first == -1 ? -1 : king.first * 8 + king.second;
+    if (info.kingSquare == -1) {
+        return info;
+    }
+    int kx = king.first;
+    int ky = king.second;
+    auto bit = [](int x, int y) { return uint64_t(1) << (x * 8 + y); };
+    auto onBoard = [](int x, int y) { return x >= 0 && x < 8 && y >= 0 && y < 8; };
+    
+    // Our pawns capture towards the king from one row behind it
+    int pawnRow = forWhite ? kx + 1 : kx - 1;
+    for (int dy = -1; dy <= 1; dy += 2) {
+        if (onBoard(pawnRow, ky + dy)) info.checkSquares[0] |= bit(pawnRow, ky + dy);
+    }
+    const int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+    for (const auto& step : knightSteps) {
+        if (onBoard(kx + step[0], ky + step[1])) info.checkSquares[1] |= bit(kx + step[0], ky + step[1]);
+    }
+    
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            if (dx == 0 && dy == 0) continue;
+            bool diagonal = dx != 0 && dy != 0;
+            
+            // Empty squares out from the king, and the first piece on the ray
+            int x = kx + dx;
+            int y = ky + dy;
+            while (onBoard(x, y)) {
+                info.checkSquares[diagonal ? 2 : 3] |= bit(x, y);
+                if (board[x][y]) break;
+                x += dx;
+                y += dy;
+            }
+            if (!onBoard(x, y) || board[x][y]->isWhite() != forWhite) continue;
+            
+            // One of our pieces with one of our matching sliders behind it
+            int sx = x + dx;
+            int sy = y + dy;
+            while (onBoard(sx, sy) && !board[sx][sy]) {
+                sx += dx;
+                sy += dy;
+            }
+            if (onBoard(sx, sy) && board[sx][sy]->isWhite() == forWhite) {
+                char slider = static_cast<char>(toupper(board[sx][sy]->getSymbol()));
+                if (slider == 'Q' || slider == (diagonal ? 'B' : 'R')) {
+                    info.discoverers |= bit(x, y);
+                }
+            }
+        }
+    }
+    info.checkSquares[4] = info.checkSquares[2] | info.checkSquares[3];
+    return info;
+}
+
+bool Board::givesCheck(int x1, int y1, int x2, int y2, const CheckInfo& info) const {
+    Piece* piece = board[x1][y1];
+    if (!piece || info.kingSquare == -1) {
+        return false;
+    }
+    
+    char type = static_cast<char>(toupper(piece->getSymbol()));
+    bool castling = type == 'K' && abs(y2 - y1) == 2;
+    bool enPassant = type == 'P' && y1 != y2 && !board[x2][y2];
+    bool promotion = type == 'P' && (x2 == 0 || x2 == 7);
+    if (castling || enPassant || promotion) {
+        Board copy = *this;
+        copy.movePiece(x1, y1, x2, y2);
+        return copy.isCheck(!piece->isWhite());
+    }
+    
+    static const char TYPES[] = "PNBRQK";
+    int typeIndex = static_cast<int>(strchr(TYPES, type) - TYPES);
+    if (info.checkSquares[typeIndex] & (uint64_t(1) << (x2 * 8 + y2))) {
+        return true;
+    }
+    
+    // Discovered check, unless the piece stays on the line to the king
+    if (info.discoverers & (uint64_t(1) << (x1 * 8 + y1))) {
+        int kx = info.kingSquare / 8;
+        int ky = info.kingSquare % 8;
+        return (x1 - kx) * (y2 - ky) != (y1 - ky) * (x2 - kx);
+    }
+    return false;
+}
+
+int Board::staticExchange(int x1, int y1, int x2, int y2) const {
+    Piece* mover = board[x1][y1];
+    if (!mover) {
+        return 0;
+    }
+    
+    char squares[64];
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            squares[i * 8 + j] = board[i][j] ? board[i][j]->getSymbol() : 0;
+        }
+    }
+    
+    // gain[d] is the balance for the side making capture d if the exchange stopped there
+    int gain[32];
+    int depth = 0;
+    int target = x2 * 8 + y2;
+    if (squares[target]) {
+        gain[0] = exchangeValue(squares[target]);
+    } else if (toupper(mover->getSymbol()) == 'P' && y1 != y2) {
+        gain[0] = exchangeValue('P'); // En passant
+        squares[x1 * 8 + y2] = 0;
+    } else {
+        gain[0] = 0;
+    }
+    
+    char onTarget = squares[x1 * 8 + y1];
+    squares[x1 * 8 + y1] = 0;
+    bool white = !mover->isWhite();
+    while (depth < 31) {
+        int from = leastValuableAttacker(squares, target, white);
+        if (from == -1) {
+            break;
+        }
+        depth++;
+        gain[depth] = exchangeValue(onTarget) - gain[depth - 1];
+        onTarget = squares[from];
+        squares[from] = 0;
+        white = !white;
+    }
+    
+    // Either side may stop capturing when continuing would lose more
+    while (depth > 0) {
+        depth--;
+        gain[depth] = -std::max(-gain[depth], gain[depth + 1]);
+    }
+    return gain[0];
+}
+
+void Board::evaluatePawnStructure(int& midgame, int& endgame) const {
+    midgame = 0;
+    endgame = 0;
+    
+    // Pawns per file, and the most and least advanced pawn of each side per file
+    // as a relative rank (1 = starting rank, 6 = about to promote)
+    int count[2][8] = {{0}};
+    int mostAdvanced[2][8];
+    int leastAdvanced[2][8];
+    for (int side = 0; side < 2; ++side) {
+        for (int file = 0; file < 8; ++file) {
+            mostAdvanced[side][file] = 0;
+            leastAdvanced[side][file] = 8;
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            Piece* piece = board[i][j];
+            if (piece && toupper(piece->getSymbol()) == 'P') {
+                int side = piece->isWhite() ? 0 : 1;
+                int rank = piece->isWhite() ? 7 - i : i;
+                count[side][j]++;
+                mostAdvanced[side][j] = std::max(mostAdvanced[side][j], rank);
+                leastAdvanced[side][j] = std::min(leastAdvanced[side][j], rank);
+            }
+        }
+    }
     
     for (int i = 0; i < 8; ++i) {
         for (int j = 0; j < 8; ++j) {
             Piece* piece = board[i][j];
-            if (piece) {
-                int value = 0;
-                char symbol = piece->getSymbol();
-                
-                switch (toupper(symbol)) {
-                    case 'P': value = 1; break;   // Pawn
-                    case 'N': value = 3; break;   // Knight
-                    case 'B': value = 3; break;   // Bishop
-                    case 'R': value = 5; break;   // Rook
-                    case 'Q': value = 9; break;   // Queen
-                    case 'K': value = 100; break; // King
+            if (!piece || toupper(piece->getSymbol()) != 'P') continue;
+            
+            int side = piece->isWhite() ? 0 : 1;
+            int enemy = 1 - side;
+            int sign = piece->isWhite() ? 1 : -1;
+            int rank = piece->isWhite() ? 7 - i : i;
+            
+            // Passed: no enemy pawn ahead on this or an adjacent file. Enemy ranks
+            // are counted from their side, so "ahead of us" is 7 - rank or less
+            bool passed = true;
+            bool isolated = true;
+            bool supportable = false;
+            for (int file = j - 1; file <= j + 1; ++file) {
+                if (file < 0 || file > 7) continue;
+                if (count[enemy][file] > 0 && leastAdvanced[enemy][file] < 7 - rank) {
+                    passed = false;
                 }
-                
-                if (piece->isWhite()) {
-                    score += value;
-                } else {
-                    score -= value;
+                if (file != j && count[side][file] > 0) {
+                    isolated = false;
+                    if (leastAdvanced[side][file] <= rank) {
+                        supportable = true;
+                    }
+                }
+            }
+            
+            if (passed) {
+                midgame += sign * PASSED_PAWN_MIDGAME[rank];
+                endgame += sign * PASSED_PAWN_ENDGAME[rank];
+            }
+            if (isolated) {
+                midgame -= sign * ISOLATED_PAWN_MIDGAME;
+                endgame -= sign * ISOLATED_PAWN_ENDGAME;
+            } else if (!supportable) {
+                // Backward: cannot be defended by a pawn and its stop square is
+                // covered by an enemy pawn
+                int stopX = i - sign;
+                bool stopAttacked = false;
+                for (int dy = -1; dy <= 1; dy += 2) {
+                    Piece* attacker = getPiece(stopX - sign, j + dy);
+                    if (attacker && toupper(attacker->getSymbol()) == 'P' && attacker->isWhite() != piece->isWhite()) {
+                        stopAttacked = true;
+                    }
+                }
+                if (stopAttacked) {
+                    midgame -= sign * BACKWARD_PAWN_MIDGAME;
+                    endgame -= sign * BACKWARD_PAWN_ENDGAME;
                 }
             }
         }
     }
     
-    return score;
+    // Doubled: every extra pawn on a file
+    for (int file = 0; file < 8; ++file) {
+        for (int side = 0; side < 2; ++side) {
+            if (count[side][file] > 1) {
+                int sign = (side == 0) ? 1 : -1;
+                midgame -= sign * DOUBLED_PAWN_MIDGAME * (count[side][file] - 1);
+                endgame -= sign * DOUBLED_PAWN_ENDGAME * (count[side][file] - 1);
+            }
+        }
+    }
+}
+
+uint64_t Board::getZobristKey(bool whiteToMove) const {
+    const auto& table = ZOBRIST_RANDOM;
+    uint64_t key = pieceKey; // Maintained by placePiece and liftPiece
+    
+    if (!hasKingMoved(true) && !hasRookMoved(true, true)) key ^= table[ZOBRIST_CASTLING + 0];
+    if (!hasKingMoved(true) && !hasRookMoved(true, false)) key ^= table[ZOBRIST_CASTLING + 1];
+    if (!hasKingMoved(false) && !hasRookMoved(false, true)) key ^= table[ZOBRIST_CASTLING + 2];
+    if (!hasKingMoved(false) && !hasRookMoved(false, false)) key ^= table[ZOBRIST_CASTLING + 3];
+    
+    // En passant only counts when the side to move has a pawn that can capture
+    if (enPassantTarget.first != -1) {
+        int pawnRow = enPassantTarget.first + (whiteToMove ? 1 : -1);
+        char pawnSymbol = whiteToMove ? 'P' : 'p';
+        for (int dy = -1; dy <= 1; dy += 2) {
+            Piece* pawn = getPiece(pawnRow, enPassantTarget.second + dy);
+            if (pawn && pawn->getSymbol() == pawnSymbol) {
+                key ^= table[ZOBRIST_EN_PASSANT + enPassantTarget.second];
+                break;
+            }
+        }
+    }
+    
+    if (whiteToMove) {
+        key ^= table[ZOBRIST_TURN];
+    }
+    
+    return key;
+}
+
+bool Board::isUnderPromotion(const std::string& san) {
+    size_t length = san.length();
+    while (length > 0 && strchr("+#!?", san[length - 1])) {
+        --length;
+    }
+    if (length < 3 || !strchr("NBR", san[length - 1])) {
+        return false;
+    }
+    size_t rank = san[length - 2] == '=' ? length - 3 : length - 2;
+    return rank > 0 && (san[rank] == '1' || san[rank] == '8') && san[rank - 1] >= 'a' && san[rank - 1] <= 'h';
+}
+
+std::pair<std::pair<int, int>, std::pair<int, int>> Board::parseSAN(const std::string& san, bool whiteToMove) const {
+    const std::pair<std::pair<int, int>, std::pair<int, int>> invalid = {{-1, -1}, {-1, -1}};
+    
+    // Drop check, mate and annotation suffixes
+    size_t length = san.length();
+    while (length > 0 && strchr("+#!?", san[length - 1])) {
+        --length;
+    }
+    std::string text = san.substr(0, length);
+    
+    int kingX = whiteToMove ? 7 : 0;
+    if (text == "O-O" || text == "0-0") {
+        return isValidMove(kingX, 4, kingX, 6) ? std::make_pair(std::make_pair(kingX, 4), std::make_pair(kingX, 6)) : invalid;
+    }
+    if (text == "O-O-O" || text == "0-0-0") {
+        return isValidMove(kingX, 4, kingX, 2) ? std::make_pair(std::make_pair(kingX, 4), std::make_pair(kingX, 2)) : invalid;
+    }
+    
+    // Promotion piece, "e8=Q" or "e8Q"
+    char promotion = 0;
+    if (text.length() >= 4 && text[text.length() - 2] == '=') {
+        promotion = text.back();
+        text.resize(text.length() - 2);
+    } else if (text.length() >= 3 && strchr("NBRQ", text.back()) && isdigit(static_cast<unsigned char>(text[text.length() - 2]))) {
+        promotion = text.back();
+        text.pop_back();
+    }
+    if (promotion && !strchr("NBRQ", promotion)) {
+        return invalid;
+    }
+    
+    char pieceType = 'P';
+    size_t pos = 0;
+    if (!text.empty() && strchr("NBRQK", text[0])) {
+        pieceType = text[0];
+        pos = 1;
+    }
+    if (text.length() < pos + 2) {
+        return invalid;
+    }
+    
+    // Destination is always the last two characters
+    char destFile = text[text.length() - 2];
+    char destRank = text[text.length() - 1];
+    if (destFile < 'a' || destFile > 'h' || destRank < '1' || destRank > '8') {
+        return invalid;
+    }
+    int destX = 8 - (destRank - '0');
+    int destY = destFile - 'a';
+    
+    // Between piece and destination: an optional origin file, rank or both, then an optional 'x'
+    std::string middle = text.substr(pos, text.length() - 2 - pos);
+    bool isCapture = !middle.empty() && middle.back() == 'x';
+    if (isCapture) {
+        middle.pop_back();
+    }
+    int fromX = -1;
+    int fromY = -1;
+    for (size_t i = 0; i < middle.length(); ++i) {
+        if (i == 0 && middle[i] >= 'a' && middle[i] <= 'h') {
+            fromY = middle[i] - 'a';
+        } else if (i == middle.length() - 1 && middle[i] >= '1' && middle[i] <= '8') {
+            fromX = 8 - (middle[i] - '0');
+        } else {
+            return invalid;
+        }
+    }
+    
+    if (pieceType == 'P') {
+        // Pushes name only the destination, captures only the origin file ("exd5")
+        bool lastRank = destX == (whiteToMove ? 0 : 7);
+        if ((isCapture ? (fromY == -1 || fromX != -1) : !middle.empty()) || (promotion && !lastRank)) {
+            return invalid;
+        }
+        // The board only promotes to a queen, so an under-promotion cannot be played
+        if (promotion && promotion != 'Q') {
+            return invalid;
+        }
+        
+        int direction = whiteToMove ? -1 : 1;
+        int x = destX - direction;
+        int y = isCapture ? fromY : destY;
+        if (!isCapture && x >= 0 && x < 8 && !board[x][y]) {
+            x -= direction; // Double push
+        }
+        char symbol = whiteToMove ? 'P' : 'p';
+        if (x < 0 || x >= 8 || !board[x][y] || board[x][y]->getSymbol() != symbol || !isValidMove(x, y, destX, destY)) {
+            return invalid;
+        }
+        return {{x, y}, {destX, destY}};
+    }
+    if (promotion) {
+        return invalid;
+    }
+    
+    // The one piece of the type that can legally reach the destination
+    char symbol = whiteToMove ? pieceType : static_cast<char>(tolower(pieceType));
+    std::pair<std::pair<int, int>, std::pair<int, int>> found = invalid;
+    for (int i = 0; i < 8; ++i) {
+        if (fromX != -1 && i != fromX) continue;
+        for (int j = 0; j < 8; ++j) {
+            if (fromY != -1 && j != fromY) continue;
+            if (!board[i][j] || board[i][j]->getSymbol() != symbol) continue;
+            if (!isValidMove(i, j, destX, destY)) continue;
+            
+            if (found.first.first != -1) {
+                return invalid; // Ambiguous
+            }
+            found = {{i, j}, {destX, destY}};
+        }
+    }
+    
+    return found;
+}
+
+std::string Board::toSAN(int x1, int y1, int x2, int y2) const {
+    Piece* piece = board[x1][y1];
+    char symbol = piece->getSymbol();
+    char type = static_cast<char>(toupper(symbol));
+    auto square = [](int x, int y) { return std::string(1, static_cast<char>('a' + y)) + static_cast<char>('0' + 8 - x); };
+    
+    std::string san;
+    if (type == 'K' && (y2 - y1 == 2 || y1 - y2 == 2)) {
+        san = y2 > y1 ? "O-O" : "O-O-O";
+    } else if (type == 'P') {
+        if (y1 != y2) {
+            san += static_cast<char>('a' + y1);
+            san += 'x';
+        }
+        san += square(x2, y2);
+        if (x2 == 0 || x2 == 7) {
+            san += "=Q";
+        }
+    } else {
+        san += type;
+        
+        // Name the origin file, else the rank, else both, if another piece of the type can go there too
+        bool ambiguous = false;
+        bool sameFile = false;
+        bool sameRank = false;
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                if ((i == x1 && j == y1) || !board[i][j] || board[i][j]->getSymbol() != symbol) continue;
+                if (!isValidMove(i, j, x2, y2)) continue;
+                ambiguous = true;
+                sameFile = sameFile || j == y1;
+                sameRank = sameRank || i == x1;
+            }
+        }
+        if (ambiguous) {
+            std::string origin = square(x1, y1);
+            san += !sameFile ? origin.substr(0, 1) : !sameRank ? origin.substr(1) : origin;
+        }
+        if (board[x2][y2]) {
+            san += 'x';
+        }
+        san += square(x2, y2);
+    }
+    
+    Board next(*this);
+    next.movePiece(x1, y1, x2, y2);
+    bool white = piece->isWhite();
+    if (next.isCheck(!white)) {
+        san += next.hasLegalMoves(!white) ? '+' : '#';
+    }
+    return san;
 }
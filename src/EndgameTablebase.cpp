@@ -0,0 +1,277 @@
+#include "../include/EndgameTablebase.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const char* const PIECE_ORDER = "KQRBNP";
+
+// All sorted piece multisets of the given size, e.g. "QR", "NN"
+void addMultisets(const std::string& prefix, size_t start, int remaining, std::vector<std::string>& out) {
+    if (remaining == 0) {
+        out.push_back(prefix);
+        return;
+    }
+    for (size_t i = start; i < 5; ++i) {
+        addMultisets(prefix + "QRBNP"[i], i, remaining - 1, out);
+    }
+}
+
+bool validHeader(const MappedFile& file, uint8_t kind, const std::string& pieces) {
+    if (file.size() < sizeof(TablebaseHeader)) {
+        return false;
+    }
+    TablebaseHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    return memcmp(header.magic, "CTB1", 4) == 0 && header.kind == kind &&
+           header.pieceCount == pieces.length() &&
+           std::string(header.pieces, header.pieceCount) == pieces;
+}
+
+} // namespace
+
+EndgameTablebase::EndgameTablebase() : maxPieces(0) {}
+
+bool EndgameTablebase::loadDirectory(const std::string& path) {
+    close();
+    directory = path;
+
+    for (int extra = 1; extra <= MAX_PIECES - 2; ++extra) {
+        for (int whiteExtra = 0; whiteExtra <= extra; ++whiteExtra) {
+            std::vector<std::string> whiteSets;
+            std::vector<std::string> blackSets;
+            addMultisets("", 0, whiteExtra, whiteSets);
+            addMultisets("", 0, extra - whiteExtra, blackSets);
+            for (const auto& white : whiteSets) {
+                for (const auto& black : blackSets) {
+                    if (openTable("K" + white + "vK" + black)) {
+                        maxPieces = std::max(maxPieces, extra + 2);
+                    }
+                }
+            }
+        }
+    }
+
+    if (tables.empty()) {
+        directory.clear();
+        return false;
+    }
+    return true;
+}
+
+void EndgameTablebase::close() {
+    tables.clear();
+    tableIndex.clear();
+    directory.clear();
+    maxPieces = 0;
+}
+
+bool EndgameTablebase::openTable(const std::string& signature) {
+    std::unique_ptr<Table> table(new Table());
+    table->pieces = getTablePieces(signature);
+    table->size = getTableSize(static_cast<int>(table->pieces.length()));
+
+    std::string base = directory + "/" + signature;
+    if (!table->wdl.open(base + ".wdl") || !validHeader(table->wdl, 0, table->pieces) ||
+        table->wdl.size() < sizeof(TablebaseHeader) + (table->size + 3) / 4) {
+        return false;
+    }
+    if (table->dtm.open(base + ".dtm") &&
+        (!validHeader(table->dtm, 1, table->pieces) || table->dtm.size() < sizeof(TablebaseHeader) + table->size)) {
+        table->dtm.close();
+    }
+
+    tableIndex[signature] = tables.size();
+    tables.push_back(std::move(table));
+    return true;
+}
+
+std::string EndgameTablebase::getSignature(const Board& board, bool swapColors) {
+    int counts[2][6] = {{0}};
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            Piece* piece = board.getPiece(i, j);
+            if (piece) {
+                const char* type = strchr(PIECE_ORDER, toupper(piece->getSymbol()));
+                counts[piece->isWhite() != swapColors ? 0 : 1][type - PIECE_ORDER]++;
+            }
+        }
+    }
+
+    std::string signature;
+    for (int side = 0; side < 2; ++side) {
+        if (side == 1) signature += 'v';
+        for (int type = 0; type < 6; ++type) {
+            signature.append(counts[side][type], PIECE_ORDER[type]);
+        }
+    }
+    return signature;
+}
+
+std::string EndgameTablebase::getTablePieces(const std::string& signature) {
+    std::string pieces;
+    bool black = false;
+    for (char c : signature) {
+        if (c == 'v') {
+            black = true;
+        } else {
+            pieces += black ? static_cast<char>(tolower(c)) : c;
+        }
+    }
+    return pieces;
+}
+
+bool EndgameTablebase::hasCastlingRights(const Board& board) {
+    // Tables assume no castling; a right only exists while king and rook are home
+    for (int side = 0; side < 2; ++side) {
+        bool white = (side == 0);
+        int row = white ? 7 : 0;
+        Piece* king = board.getPiece(row, 4);
+        if (!king || king->getSymbol() != (white ? 'K' : 'k') || board.hasKingMoved(white)) {
+            continue;
+        }
+        for (int wing = 0; wing < 2; ++wing) {
+            bool kingSide = (wing == 0);
+            Piece* rook = board.getPiece(row, kingSide ? 7 : 0);
+            if (rook && rook->getSymbol() == (white ? 'R' : 'r') && !board.hasRookMoved(white, kingSide)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const EndgameTablebase::Table* EndgameTablebase::locate(const Board& board, bool whiteToMove, uint64_t& index) const {
+    bool swapColors = false;
+    auto it = tableIndex.find(getSignature(board, false));
+    if (it == tableIndex.end()) {
+        swapColors = true;
+        it = tableIndex.find(getSignature(board, true));
+        if (it == tableIndex.end()) {
+            return nullptr;
+        }
+    }
+    const Table* table = tables[it->second].get();
+
+    // Assign each table piece to a distinct square holding that piece
+    bool used[64] = {false};
+    uint64_t squares = 0;
+    uint64_t scale = 1;
+    for (char symbol : table->pieces) {
+        int found = -1;
+        for (int sq = 0; sq < 64 && found == -1; ++sq) {
+            int x = sq / 8;
+            int y = sq % 8;
+            Piece* piece = board.getPiece(swapColors ? 7 - x : x, y);
+            if (!used[sq] && piece) {
+                char pieceSymbol = piece->getSymbol();
+                if (swapColors) {
+                    pieceSymbol = isupper(pieceSymbol) ? static_cast<char>(tolower(pieceSymbol)) : static_cast<char>(toupper(pieceSymbol));
+                }
+                if (pieceSymbol == symbol) {
+                    found = sq;
+                }
+            }
+        }
+        if (found == -1) {
+            return nullptr;
+        }
+        used[found] = true;
+        squares += scale * found;
+        scale *= 64;
+    }
+
+    bool stmWhite = swapColors ? !whiteToMove : whiteToMove;
+    index = (stmWhite ? 0 : 1) + 2 * squares;
+    return table;
+}
+
+bool EndgameTablebase::probeWDL(const Board& board, bool whiteToMove, int& wdl) const {
+    int pliesToMate;
+    return probeDTM(board, whiteToMove, wdl, pliesToMate);
+}
+
+bool EndgameTablebase::probeDTM(const Board& board, bool whiteToMove, int& wdl, int& pliesToMate) const {
+    if (tables.empty() || board.getEnPassantTarget().first != -1 || hasCastlingRights(board)) {
+        return false;
+    }
+
+    std::string signature = getSignature(board, false);
+    if (signature == "KvK") {
+        wdl = TB_DRAW;
+        pliesToMate = -1;
+        return true;
+    }
+    if (static_cast<int>(signature.length()) - 1 > maxPieces) {
+        return false;
+    }
+
+    uint64_t index;
+    const Table* table = locate(board, whiteToMove, index);
+    if (!table) {
+        return false;
+    }
+
+    const unsigned char* wdlData = table->wdl.data() + sizeof(TablebaseHeader);
+    wdl = (wdlData[index >> 2] >> ((index & 3) * 2)) & 3;
+    if (wdl == TB_UNKNOWN) {
+        return false;
+    }
+
+    pliesToMate = -1;
+    if (table->dtm.isOpen() && wdl != TB_DRAW) {
+        int value = table->dtm.data()[sizeof(TablebaseHeader) + index];
+        pliesToMate = (value == 255) ? -1 : value;
+    }
+    return true;
+}
+
+bool EndgameTablebase::probeRoot(const Board& board, bool whiteToMove, std::pair<std::pair<int, int>, std::pair<int, int>>& move) const {
+    int rootWDL;
+    if (!probeWDL(board, whiteToMove, rootWDL)) {
+        return false;
+    }
+
+    bool found = false;
+    int bestRank = 0;
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            Piece* piece = board.getPiece(i, j);
+            if (!piece || piece->isWhite() != whiteToMove) continue;
+
+            for (const auto& target : board.getLegalMoves(i, j)) {
+                Board child = board;
+                child.movePiece(i, j, target.first, target.second);
+
+                int childWDL;
+                int childDTM;
+                if (!probeDTM(child, !whiteToMove, childWDL, childDTM)) {
+                    return false; // A missing table leaves the choice to the search
+                }
+                // Without a distance every decisive move ranks the same, and playing
+                // the first one can shuffle forever; the search makes progress instead
+                if (childDTM < 0 && rootWDL != TB_DRAW && childWDL != TB_DRAW) {
+                    return false;
+                }
+
+                // Higher rank is better for us: fast wins, then draws, then slow losses
+                int rank;
+                if (childWDL == TB_LOSS) {
+                    rank = 2000 - (childDTM < 0 ? 999 : childDTM);
+                } else if (childWDL == TB_DRAW) {
+                    rank = 0;
+                } else {
+                    rank = -2000 + (childDTM < 0 ? 999 : childDTM);
+                }
+
+                if (!found || rank > bestRank) {
+                    found = true;
+                    bestRank = rank;
+                    move = {{i, j}, target};
+                }
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,48 @@
+#include "../include/EvalCache.h"
+
+namespace {
+
+const uint64_t VALID_BIT = 1ULL << 32;
+
+} // namespace
+
+EvalCache::EvalCache(size_t sizeKB) : mask(0) {
+    resize(sizeKB);
+}
+
+void EvalCache::resize(size_t sizeKB) {
+    // Round the entry count down to a power of two so indexing is a mask
+    size_t count = (sizeKB * 1024) / sizeof(Entry);
+    size_t size = 1;
+    while (size * 2 <= count) {
+        size *= 2;
+    }
+    entries.reset(new Entry[size]);
+    mask = size - 1;
+    clear();
+}
+
+void EvalCache::clear() {
+    for (size_t i = 0; i <= mask; ++i) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool EvalCache::probe(uint64_t key, int& score) const {
+    const Entry& slot = entries[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if (!(data & VALID_BIT) || (check ^ data) != key) {
+        return false;
+    }
+    score = static_cast<int32_t>(static_cast<uint32_t>(data));
+    return true;
+}
+
+void EvalCache::store(uint64_t key, int score) {
+    Entry& slot = entries[key & mask];
+    uint64_t data = VALID_BIT | static_cast<uint32_t>(score);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
@@ -0,0 +1,408 @@
+#include "../include/GameArchive.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'C', 'G', 'A', '1'};
+const char* const RESULTS[] = {"*", "1-0", "0-1", "1/2-1/2"};
+const int RESULT_COUNT = 4;
+
+uint64_t readLittleEndian(const unsigned char* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = count - 1; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void writeLittleEndian(uint64_t value, unsigned char* bytes, int count) {
+    for (int i = 0; i < count; ++i) {
+        bytes[i] = static_cast<unsigned char>(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+void putVarint(std::string& bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    bytes += static_cast<char>(value);
+}
+
+void putString(std::string& bytes, const std::string& text) {
+    putVarint(bytes, text.size());
+    bytes += text;
+}
+
+// Reads stop at end; false if the value or string runs past it
+bool getVarint(const unsigned char*& cursor, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        unsigned char byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getString(const unsigned char*& cursor, const unsigned char* end, std::string& text) {
+    uint64_t length;
+    if (!getVarint(cursor, end, length) || length > static_cast<uint64_t>(end - cursor)) {
+        return false;
+    }
+    text.assign(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+    cursor += length;
+    return true;
+}
+
+int resultCode(const std::string& result) {
+    for (int i = 1; i < RESULT_COUNT; ++i) {
+        if (result == RESULTS[i]) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+typedef std::pair<std::pair<int, int>, std::pair<int, int>> BoardMove;
+
+// Position of a move among the candidate targets of the mover's pieces, taken
+// piece by piece in board order. Candidates need no legality test, so both ways
+// cost a few array walks; only the one move played is checked
+bool encodeMove(const Board& board, bool whiteToMove, const BoardMove& move, uint64_t& index) {
+    Piece* moving = board.getPiece(move.first.first, move.first.second);
+    if (!moving || moving->isWhite() != whiteToMove ||
+        !board.isValidMove(move.first.first, move.first.second, move.second.first, move.second.second)) {
+        return false;
+    }
+    std::pair<int, int> targets[Board::MAX_TARGETS];
+    index = 0;
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            Piece* piece = board.getPiece(x, y);
+            if (!piece || piece->isWhite() != whiteToMove) continue;
+            int count = board.getCandidateTargets(x, y, targets);
+            if (x == move.first.first && y == move.first.second) {
+                for (int k = 0; k < count; ++k) {
+                    if (targets[k] == move.second) {
+                        index += k;
+                        return true;
+                    }
+                }
+                return false;
+            }
+            index += count;
+        }
+    }
+    return false;
+}
+
+bool decodeMove(const Board& board, bool whiteToMove, uint64_t index, BoardMove& move) {
+    std::pair<int, int> targets[Board::MAX_TARGETS];
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            Piece* piece = board.getPiece(x, y);
+            if (!piece || piece->isWhite() != whiteToMove) continue;
+            int count = board.getCandidateTargets(x, y, targets);
+            if (index < static_cast<uint64_t>(count)) {
+                move = {{x, y}, targets[index]};
+                return board.isValidMove(x, y, move.second.first, move.second.second);
+            }
+            index -= count;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+GameArchive::GameArchive() : gameCount(0), indexOffset(0) {}
+
+bool GameArchive::open(const std::string& path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // The index must fit between indexOffset and the end of the file
+    ArchiveHeader header;
+    bool valid = file.size() >= HEADER_SIZE;
+    if (valid) {
+        header = readHeader(file.data());
+        valid = std::memcmp(header.magic, MAGIC, 4) == 0 && header.version == VERSION &&
+                header.indexOffset >= HEADER_SIZE && header.indexOffset <= file.size() &&
+                (file.size() - header.indexOffset) / INDEX_ENTRY_SIZE >= header.gameCount;
+    }
+    if (!valid) {
+        file.close();
+        return false;
+    }
+    gameCount = header.gameCount;
+    indexOffset = header.indexOffset;
+    return true;
+}
+
+void GameArchive::close() {
+    file.close();
+    gameCount = 0;
+    indexOffset = 0;
+}
+
+bool GameArchive::readGame(size_t index, PgnGame& game) const {
+    if (index >= gameCount) {
+        return false;
+    }
+    const unsigned char* entry = file.data() + indexOffset + INDEX_ENTRY_SIZE * index;
+    uint64_t begin = readLittleEndian(entry, 8);
+    uint64_t end = readLittleEndian(entry + 8, 8);
+    if (begin < HEADER_SIZE || begin > end || end > indexOffset) {
+        game = PgnGame();
+        game.error = "index entry " + std::to_string(index + 1) + " points outside the game records";
+        return true;
+    }
+    decode(file.data() + begin, file.data() + end, game);
+    return true;
+}
+
+bool GameArchive::encode(const PgnGame& game, std::string& bytes) {
+    Board board;
+    bool whiteToMove = true;
+    int fullmoveNumber = 1;
+    if (!game.startFEN.empty() && !board.loadFEN(game.startFEN, whiteToMove, fullmoveNumber)) {
+        return false;
+    }
+
+    size_t start = bytes.size();
+    putVarint(bytes, game.tags.size());
+    for (const auto& tag : game.tags) {
+        putString(bytes, tag.first);
+        putString(bytes, tag.second);
+    }
+    putString(bytes, game.startFEN);
+    bytes += static_cast<char>(resultCode(game.result));
+
+    putVarint(bytes, game.moves.size());
+    for (const auto& move : game.moves) {
+        uint64_t index;
+        if (!encodeMove(board, whiteToMove, move, index)) {
+            bytes.resize(start);
+            return false;
+        }
+        putVarint(bytes, index);
+        board.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+        whiteToMove = !whiteToMove;
+    }
+    return true;
+}
+
+void GameArchive::decode(const unsigned char* begin, const unsigned char* end, PgnGame& game) {
+    game = PgnGame();
+    const unsigned char* cursor = begin;
+
+    uint64_t tagCount;
+    if (!getVarint(cursor, end, tagCount)) {
+        game.error = "truncated record";
+        return;
+    }
+    for (uint64_t i = 0; i < tagCount; ++i) {
+        std::string name;
+        std::string value;
+        if (!getString(cursor, end, name) || !getString(cursor, end, value)) {
+            game.error = "truncated tag";
+            return;
+        }
+        game.tags.push_back({name, value});
+    }
+
+    uint64_t moveCount;
+    if (!getString(cursor, end, game.startFEN) || cursor == end) {
+        game.error = "truncated record";
+        return;
+    }
+    unsigned char result = *cursor++;
+    game.result = result < RESULT_COUNT ? RESULTS[result] : "*";
+    if (result >= RESULT_COUNT || !getVarint(cursor, end, moveCount)) {
+        game.error = "invalid result or move count";
+        return;
+    }
+
+    Board board;
+    bool whiteToMove = true;
+    int fullmoveNumber = 1;
+    if (!game.startFEN.empty() && !board.loadFEN(game.startFEN, whiteToMove, fullmoveNumber)) {
+        game.error = "invalid start position " + game.startFEN;
+        return;
+    }
+
+    // Every move takes at least one byte, which bounds the reservation
+    game.moves.reserve(static_cast<size_t>(std::min<uint64_t>(moveCount, end - cursor)));
+    for (uint64_t ply = 0; ply < moveCount; ++ply) {
+        uint64_t index;
+        BoardMove move;
+        if (!getVarint(cursor, end, index) || !decodeMove(board, whiteToMove, index, move)) {
+            game.error = "invalid move at ply " + std::to_string(ply + 1);
+            return;
+        }
+        game.moves.push_back(move);
+        board.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+        whiteToMove = !whiteToMove;
+    }
+    if (cursor != end) {
+        game.error = "trailing bytes after the moves";
+    }
+}
+
+ArchiveHeader GameArchive::readHeader(const unsigned char* bytes) {
+    ArchiveHeader header;
+    std::memcpy(header.magic, bytes, 4);
+    header.version = static_cast<uint16_t>(readLittleEndian(bytes + 4, 2));
+    header.flags = static_cast<uint16_t>(readLittleEndian(bytes + 6, 2));
+    header.gameCount = static_cast<uint32_t>(readLittleEndian(bytes + 8, 4));
+    header.reserved = static_cast<uint32_t>(readLittleEndian(bytes + 12, 4));
+    header.indexOffset = readLittleEndian(bytes + 16, 8);
+    return header;
+}
+
+void GameArchive::writeHeader(const ArchiveHeader& header, unsigned char* bytes) {
+    std::memcpy(bytes, header.magic, 4);
+    writeLittleEndian(header.version, bytes + 4, 2);
+    writeLittleEndian(header.flags, bytes + 6, 2);
+    writeLittleEndian(header.gameCount, bytes + 8, 4);
+    writeLittleEndian(header.reserved, bytes + 12, 4);
+    writeLittleEndian(header.indexOffset, bytes + 16, 8);
+}
+
+GameArchiveWriter::GameArchiveWriter() : dataEnd(GameArchive::HEADER_SIZE), failed(false) {}
+
+GameArchiveWriter::~GameArchiveWriter() {
+    close();
+}
+
+bool GameArchiveWriter::open(const std::string& path, bool append) {
+    close();
+    failed = false;
+    records.clear();
+    if (append) {
+        file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (file.is_open()) {
+            if (!readIndex()) {
+                file.close();
+                records.clear();
+                return false;
+            }
+            return true;
+        }
+    }
+
+    // The header is written on close; until then the space is reserved
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    buffer.assign(GameArchive::HEADER_SIZE, '\0');
+    dataEnd = GameArchive::HEADER_SIZE;
+    return true;
+}
+
+bool GameArchiveWriter::readIndex() {
+    unsigned char bytes[GameArchive::HEADER_SIZE];
+    file.seekg(0, std::ios::end);
+    uint64_t size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+    if (size < GameArchive::HEADER_SIZE || !file.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    ArchiveHeader header = GameArchive::readHeader(bytes);
+    if (std::memcmp(header.magic, MAGIC, 4) != 0 || header.version != GameArchive::VERSION ||
+        header.indexOffset < GameArchive::HEADER_SIZE || header.indexOffset > size ||
+        (size - header.indexOffset) / GameArchive::INDEX_ENTRY_SIZE < header.gameCount) {
+        return false;
+    }
+
+    std::vector<unsigned char> index(GameArchive::INDEX_ENTRY_SIZE * static_cast<size_t>(header.gameCount));
+    file.seekg(static_cast<std::streamoff>(header.indexOffset));
+    if (!index.empty() && !file.read(reinterpret_cast<char*>(index.data()), static_cast<std::streamsize>(index.size()))) {
+        return false;
+    }
+    for (size_t i = 0; i < header.gameCount; ++i) {
+        const unsigned char* entry = index.data() + GameArchive::INDEX_ENTRY_SIZE * i;
+        records.push_back({readLittleEndian(entry, 8), readLittleEndian(entry + 8, 8)});
+    }
+
+    // New records go after everything in the file, the old index and anything a
+    // crashed append left included, so the header keeps describing intact data
+    // until close rewrites it
+    file.seekp(static_cast<std::streamoff>(size));
+    dataEnd = size;
+    buffer.clear();
+    return static_cast<bool>(file);
+}
+
+bool GameArchiveWriter::write(const PgnGame& game) {
+    size_t start = buffer.size();
+    if (!GameArchive::encode(game, buffer)) {
+        return false;
+    }
+    uint64_t begin = dataEnd;
+    dataEnd += buffer.size() - start;
+    records.push_back({begin, dataEnd});
+    if (buffer.size() >= FLUSH_SIZE) {
+        flush();
+    }
+    return true;
+}
+
+bool GameArchiveWriter::flush() {
+    if (!buffer.empty()) {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    failed = failed || !file;
+    return !failed;
+}
+
+bool GameArchiveWriter::close() {
+    if (!file.is_open()) {
+        return true;
+    }
+
+    // The index follows the last record. The header, pointing at it, is written
+    // only once the records and index are out, so it never points at missing data
+    for (const auto& record : records) {
+        unsigned char bytes[GameArchive::INDEX_ENTRY_SIZE];
+        writeLittleEndian(record.first, bytes, 8);
+        writeLittleEndian(record.second, bytes + 8, 8);
+        buffer.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+    flush();
+    file.flush();
+    if (failed || !file) {
+        file.close();
+        records.clear();
+        buffer.clear();
+        return false;
+    }
+
+    ArchiveHeader header;
+    std::memcpy(header.magic, MAGIC, 4);
+    header.version = GameArchive::VERSION;
+    header.flags = 0;
+    header.gameCount = static_cast<uint32_t>(records.size());
+    header.reserved = 0;
+    header.indexOffset = dataEnd;
+    unsigned char bytes[GameArchive::HEADER_SIZE];
+    GameArchive::writeHeader(header, bytes);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    file.flush();
+    failed = failed || !file;
+
+    file.close();
+    records.clear();
+    buffer.clear();
+    return !failed;
+}
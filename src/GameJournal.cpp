@@ -0,0 +1,328 @@
+#include "../include/GameJournal.h"
+#include "../include/MappedFile.h"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'C', 'G', 'J', '1'};
+const unsigned char RECORD_GAME = 1;
+const unsigned char RECORD_MOVE = 2;
+
+const std::array<uint32_t, 256>& crcTable() {
+    static std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> values;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            values[i] = value;
+        }
+        return values;
+    }();
+    return table;
+}
+
+uint32_t crc32(const unsigned char* bytes, size_t length) {
+    const std::array<uint32_t, 256>& table = crcTable();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void putVarint(std::string& bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    bytes += static_cast<char>(value);
+}
+
+void putString(std::string& bytes, const std::string& text) {
+    putVarint(bytes, text.size());
+    bytes += text;
+}
+
+// Reads stop at end; false if the value or string runs past it
+bool getVarint(const unsigned char*& cursor, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        unsigned char byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getString(const unsigned char*& cursor, const unsigned char* end, std::string& text) {
+    uint64_t length;
+    if (!getVarint(cursor, end, length) || length > static_cast<uint64_t>(end - cursor)) {
+        return false;
+    }
+    text.assign(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+    cursor += length;
+    return true;
+}
+
+// True if there is no file at path, or an empty one, or a journal of any version
+bool isReplaceable(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) {
+        return true;
+    }
+    char magic[4];
+    if (!input.read(magic, sizeof(magic))) {
+        return input.gcount() == 0;
+    }
+    return std::memcmp(magic, MAGIC, 4) == 0;
+}
+
+// A GAME record's payload into game; false if it does not parse or its position is invalid
+bool readGameRecord(const unsigned char* cursor, const unsigned char* end, PgnGame& game, Board& board, bool& whiteToMove) {
+    game = PgnGame();
+    uint64_t tagCount;
+    if (!getVarint(cursor, end, tagCount)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < tagCount; ++i) {
+        std::string name;
+        std::string value;
+        if (!getString(cursor, end, name) || !getString(cursor, end, value)) {
+            return false;
+        }
+        game.tags.push_back({name, value});
+    }
+    if (!getString(cursor, end, game.startFEN) || cursor != end) {
+        return false;
+    }
+
+    int fullmoveNumber = 1;
+    whiteToMove = true;
+    if (game.startFEN.empty()) {
+        board.resetBoard();
+        return true;
+    }
+    return board.loadFEN(game.startFEN, whiteToMove, fullmoveNumber);
+}
+
+} // namespace
+
+GameJournal::GameJournal() : file(nullptr), syncBatch(SYNC_BATCH), unsynced(0) {}
+
+GameJournal::~GameJournal() {
+    close();
+}
+
+bool GameJournal::create(const std::string& journalPath, const PgnGame& game) {
+    close();
+    // Saving over an archive or some other file would destroy it
+    if (!isReplaceable(journalPath)) {
+        return false;
+    }
+    std::string temporaryPath = journalPath + ".tmp";
+    file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    unsigned char header[HEADER_SIZE] = {0};
+    std::memcpy(header, MAGIC, 4);
+    header[4] = static_cast<unsigned char>(VERSION & 0xFF);
+    header[5] = static_cast<unsigned char>(VERSION >> 8);
+    bool written = std::fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE;
+
+    std::string payload;
+    putVarint(payload, game.tags.size());
+    for (const auto& tag : game.tags) {
+        putString(payload, tag.first);
+        putString(payload, tag.second);
+    }
+    putString(payload, game.startFEN);
+    written = written && writeRecord(RECORD_GAME, payload);
+    for (const auto& move : game.moves) {
+        written = written && appendMove(move.first.first, move.first.second, move.second.first, move.second.second);
+    }
+    if (!written || !sync()) {
+        close();
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    // The open stream follows the file through the rename, so moves keep going to it
+#ifdef _WIN32
+    std::remove(journalPath.c_str()); // rename does not replace an existing file here
+#endif
+    if (std::rename(temporaryPath.c_str(), journalPath.c_str()) != 0) {
+        close();
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    path = journalPath;
+    return true;
+}
+
+bool GameJournal::resume(const std::string& journalPath, uint64_t validBytes) {
+    close();
+
+    // Records after a damaged one can never be replayed, so they are dropped before appending
+#ifndef _WIN32
+    if (::truncate(journalPath.c_str(), static_cast<off_t>(validBytes)) != 0) {
+        return false;
+    }
+#else
+    std::string kept;
+    {
+        std::ifstream input(journalPath, std::ios::binary);
+        kept.resize(static_cast<size_t>(validBytes));
+        if (!input.read(&kept[0], static_cast<std::streamsize>(validBytes))) {
+            return false;
+        }
+    }
+    std::ofstream output(journalPath, std::ios::binary | std::ios::trunc);
+    if (!output.write(kept.data(), static_cast<std::streamsize>(kept.size()))) {
+        return false;
+    }
+    output.close();
+#endif
+
+    file = std::fopen(journalPath.c_str(), "ab");
+    if (!file) {
+        return false;
+    }
+    path = journalPath;
+    unsynced = 0;
+    return true;
+}
+
+void GameJournal::close() {
+    if (file) {
+        sync();
+        std::fclose(file);
+        file = nullptr;
+    }
+    path.clear();
+    unsynced = 0;
+}
+
+bool GameJournal::appendMove(int x1, int y1, int x2, int y2) {
+    std::string payload;
+    payload += static_cast<char>(x1 * 8 + y1);
+    payload += static_cast<char>(x2 * 8 + y2);
+    if (!writeRecord(RECORD_MOVE, payload)) {
+        return false;
+    }
+    return unsynced < syncBatch || sync();
+}
+
+bool GameJournal::sync() {
+    if (!file) {
+        return false;
+    }
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifndef _WIN32
+    if (unsynced > 0 && fsync(fileno(file)) != 0) {
+        return false;
+    }
+#endif
+    unsynced = 0;
+    return true;
+}
+
+bool GameJournal::writeRecord(unsigned char type, const std::string& payload) {
+    if (!file) {
+        return false;
+    }
+    std::string record;
+    record += static_cast<char>(type);
+    putVarint(record, payload.size());
+    record += payload;
+    uint32_t crc = crc32(reinterpret_cast<const unsigned char*>(record.data()), record.size());
+    for (int i = 0; i < 4; ++i) {
+        record += static_cast<char>((crc >> (8 * i)) & 0xFF);
+    }
+
+    // Flushed at once: a record left in the stdio buffer would die with the process
+    if (std::fwrite(record.data(), 1, record.size(), file) != record.size() || std::fflush(file) != 0) {
+        return false;
+    }
+    unsynced++;
+    return true;
+}
+
+bool GameJournal::recover(const std::string& journalPath, PgnGame& game, uint64_t& validBytes) {
+    MappedFile input;
+    if (!input.open(journalPath) || input.size() < HEADER_SIZE || std::memcmp(input.data(), MAGIC, 4) != 0 ||
+        (input.data()[4] | (input.data()[5] << 8)) != VERSION) {
+        return false;
+    }
+
+    game = PgnGame();
+    Board board;
+    bool whiteToMove = true;
+    bool started = false;
+    const unsigned char* begin = input.data();
+    const unsigned char* end = begin + input.size();
+    const unsigned char* cursor = begin + HEADER_SIZE;
+    validBytes = HEADER_SIZE;
+
+    // Each record is checked in full before anything it says is applied
+    while (cursor < end) {
+        const unsigned char* record = cursor++;
+        unsigned char type = *record;
+        uint64_t length;
+        if (!getVarint(cursor, end, length) || length > static_cast<uint64_t>(end - cursor) ||
+            static_cast<uint64_t>(end - cursor) - length < 4) {
+            game.error = "journal ends in a partly written record";
+            break;
+        }
+        const unsigned char* payload = cursor;
+        const unsigned char* checksum = payload + length;
+        uint32_t stored = static_cast<uint32_t>(checksum[0]) | (static_cast<uint32_t>(checksum[1]) << 8) |
+                          (static_cast<uint32_t>(checksum[2]) << 16) | (static_cast<uint32_t>(checksum[3]) << 24);
+        if (crc32(record, static_cast<size_t>(checksum - record)) != stored) {
+            game.error = "checksum mismatch at byte " + std::to_string(record - begin);
+            break;
+        }
+
+        if (type == RECORD_GAME) {
+            PgnGame next;
+            if (!readGameRecord(payload, checksum, next, board, whiteToMove)) {
+                game.error = "invalid game record at byte " + std::to_string(record - begin);
+                break;
+            }
+            game = next;
+            started = true;
+        } else if (type == RECORD_MOVE && started && length == 2 && payload[0] < 64 && payload[1] < 64) {
+            int x1 = payload[0] / 8, y1 = payload[0] % 8;
+            int x2 = payload[1] / 8, y2 = payload[1] % 8;
+            Piece* piece = board.getPiece(x1, y1);
+            if (!piece || piece->isWhite() != whiteToMove || !board.isValidMove(x1, y1, x2, y2)) {
+                game.error = "illegal move at ply " + std::to_string(game.moves.size() + 1);
+                break;
+            }
+            board.movePiece(x1, y1, x2, y2);
+            game.moves.push_back({{x1, y1}, {x2, y2}});
+            whiteToMove = !whiteToMove;
+        } else {
+            game.error = "unexpected record at byte " + std::to_string(record - begin);
+            break;
+        }
+        cursor = checksum + 4;
+        validBytes = static_cast<uint64_t>(cursor - begin);
+    }
+
+    return started;
+}
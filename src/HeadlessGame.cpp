@@ -0,0 +1,176 @@
+#include "../include/HeadlessGame.h"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+const char* const HeadlessGame::START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+bool HeadlessGame::readOpenings(const std::string& path, std::vector<std::string>& openings) {
+    openings.clear();
+    if (!path.empty()) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::string line;
+        Board board;
+        bool whiteToMove;
+        int fullmoveNumber;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            if (board.loadFEN(line, whiteToMove, fullmoveNumber)) {
+                openings.push_back(line);
+            }
+        }
+    }
+    if (openings.empty()) {
+        openings.push_back(START_FEN);
+    }
+    return true;
+}
+
+bool EngineConfig::parse(const std::string& spec) {
+    name = spec;
+    limits = SearchLimits();
+    network.clear();
+    
+    std::string strength = spec;
+    size_t comma = spec.find(',');
+    if (comma != std::string::npos) {
+        strength = spec.substr(0, comma);
+        std::string option = spec.substr(comma + 1);
+        if (option.compare(0, 5, "eval=") != 0 || option.size() == 5) {
+            return false;
+        }
+        network = option.substr(5);
+    }
+    
+    auto number = [&strength](size_t prefix) { return std::atoi(strength.c_str() + prefix); };
+    if (strength == "random") {
+        difficulty = AIDifficulty::RANDOM;
+    } else if (strength == "greedy") {
+        difficulty = AIDifficulty::GREEDY;
+    } else if (strength == "minimax1") {
+        difficulty = AIDifficulty::MINIMAX_1;
+    } else if (strength == "minimax2") {
+        difficulty = AIDifficulty::MINIMAX_2;
+    } else if (strength == "minimax3") {
+        difficulty = AIDifficulty::MINIMAX_3;
+    } else if (strength.compare(0, 5, "depth") == 0 && number(5) > 0) {
+        limits.depth = number(5);
+    } else if (strength.compare(0, 5, "nodes") == 0 && number(5) > 0) {
+        limits.nodes = static_cast<uint64_t>(number(5));
+    } else if (strength.compare(0, 8, "movetime") == 0 && number(8) > 0) {
+        limits.moveTime = number(8);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool EngineConfig::apply(Game& engine) const {
+    if (network.empty()) {
+        return true;
+    }
+    return engine.setNetwork(network == "pst" ? "" : network);
+}
+
+HeadlessGame::HeadlessGame(const std::string& fen, int maxPlies) : startFEN(fen), maxPlies(maxPlies), result("*") {}
+
+bool HeadlessGame::isInsufficientMaterial(const Board& board) {
+    // Kings and at most one knight or bishop between them
+    int minors = 0;
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            Piece* piece = board.getPiece(i, j);
+            if (!piece) continue;
+            char type = static_cast<char>(toupper(piece->getSymbol()));
+            if (type == 'N' || type == 'B') {
+                minors++;
+            } else if (type != 'K') {
+                return false;
+            }
+        }
+    }
+    return minors <= 1;
+}
+
+void HeadlessGame::play(Game& white, const EngineConfig& whiteConfig, Game& black, const EngineConfig& blackConfig,
+                        int randomPlies, unsigned seed) {
+    Board board;
+    bool whiteToMove = true;
+    int fullmoveNumber = 1;
+    moves.clear();
+    result = "*";
+    reason.clear();
+    if (!board.loadFEN(startFEN, whiteToMove, fullmoveNumber)) {
+        reason = "Invalid start position";
+        return;
+    }
+    
+    std::mt19937 rng(seed);
+    while (true) {
+        std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> legalMoves;
+        board.generateMoves(whiteToMove, legalMoves);
+        if (legalMoves.empty()) {
+            if (board.isCheck(whiteToMove)) {
+                result = whiteToMove ? "0-1" : "1-0";
+                reason = std::string(whiteToMove ? "Black" : "White") + " mates";
+            } else {
+                result = "1/2-1/2";
+                reason = "Stalemate";
+            }
+            return;
+        }
+        if (board.countRepetitions() >= 3) {
+            result = "1/2-1/2";
+            reason = "Threefold repetition";
+            return;
+        }
+        if (board.isFiftyMoveDraw()) {
+            result = "1/2-1/2";
+            reason = "Fifty-move rule";
+            return;
+        }
+        if (isInsufficientMaterial(board)) {
+            result = "1/2-1/2";
+            reason = "Insufficient material";
+            return;
+        }
+        if (static_cast<int>(moves.size()) >= maxPlies) {
+            result = "1/2-1/2";
+            reason = "Adjudicated after " + std::to_string(maxPlies) + " plies";
+            return;
+        }
+        
+        std::pair<std::pair<int, int>, std::pair<int, int>> move;
+        if (static_cast<int>(moves.size()) < randomPlies) {
+            move = legalMoves[rng() % legalMoves.size()];
+        } else if (whiteToMove) {
+            move = white.chooseMove(board, true, whiteConfig.difficulty, whiteConfig.limits);
+        } else {
+            move = black.chooseMove(board, false, blackConfig.difficulty, blackConfig.limits);
+        }
+        board.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+        moves.push_back(move);
+        whiteToMove = !whiteToMove;
+    }
+}
+
+PgnGame HeadlessGame::toRecord(const std::string& event, const std::string& date, int round,
+                               const std::string& whiteName, const std::string& blackName) const {
+    PgnGame record;
+    record.tags = {{"Event", event}, {"Site", "Local"}, {"Date", date}, {"Round", std::to_string(round)},
+                   {"White", whiteName}, {"Black", blackName}, {"Result", result}};
+    if (startFEN != START_FEN) {
+        record.startFEN = startFEN;
+        record.tags.push_back({"SetUp", "1"});
+        record.tags.push_back({"FEN", startFEN});
+    }
+    record.tags.push_back({"PlyCount", std::to_string(moves.size())});
+    record.moves = moves;
+    record.result = result;
+    return record;
+}
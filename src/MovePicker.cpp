@@ -0,0 +1,140 @@
+#include "../include/MovePicker.h"
+#include "../include/TranspositionTable.h"
+#include <algorithm>
+
+namespace {
+
+int pack(const std::pair<std::pair<int, int>, std::pair<int, int>>& move) {
+    return TranspositionTable::packMove(move.first.first, move.first.second, move.second.first, move.second.second);
+}
+
+std::pair<std::pair<int, int>, std::pair<int, int>> unpack(int packedMove) {
+    int x1, y1, x2, y2;
+    TranspositionTable::unpackMove(packedMove, x1, y1, x2, y2);
+    return {{x1, y1}, {x2, y2}};
+}
+
+} // namespace
+
+MovePicker::MovePicker(const Board& board, bool forWhite, const CheckInfo& checkInfo, int hashMove, const int killers[2])
+    : board(board), forWhite(forWhite), checkInfo(checkInfo), hashMove(hashMove), stage(Stage::HASH_MOVE), index(0) {
+    this->killers[0] = killers[0];
+    this->killers[1] = killers[1] != killers[0] ? killers[1] : -1;
+}
+
+bool MovePicker::isLegal(int packedMove) const {
+    if (packedMove < 0) {
+        return false;
+    }
+    int x1, y1, x2, y2;
+    TranspositionTable::unpackMove(packedMove, x1, y1, x2, y2);
+    Piece* piece = board.getPiece(x1, y1);
+    return piece && piece->isWhite() == forWhite && board.isValidMove(x1, y1, x2, y2);
+}
+
+bool MovePicker::isHashOrKiller(const std::pair<std::pair<int, int>, std::pair<int, int>>& move) const {
+    int packedMove = pack(move);
+    return packedMove == hashMove || packedMove == killers[0] || packedMove == killers[1];
+}
+
+bool MovePicker::next(std::pair<std::pair<int, int>, std::pair<int, int>>& move) {
+    while (true) {
+        switch (stage) {
+            case Stage::HASH_MOVE:
+                stage = Stage::GENERATE_CAPTURES;
+                // Table entries can come from a colliding position, so check before trusting it
+                if (isLegal(hashMove)) {
+                    move = unpack(hashMove);
+                    return true;
+                }
+                hashMove = -1;
+                break;
+
+            case Stage::GENERATE_CAPTURES: {
+                board.generateCaptures(forWhite, moves);
+                std::vector<std::pair<int, std::pair<std::pair<int, int>, std::pair<int, int>>>> scored;
+                for (const auto& capture : moves) {
+                    if (pack(capture) == hashMove) continue;
+                    int exchange = board.staticExchange(capture.first.first, capture.first.second,
+                                                        capture.second.first, capture.second.second);
+                    if (exchange < 0) {
+                        badCaptures.push_back(capture);
+                    } else {
+                        scored.push_back({exchange, capture});
+                    }
+                }
+                std::stable_sort(scored.begin(), scored.end(),
+                                 [](const std::pair<int, std::pair<std::pair<int, int>, std::pair<int, int>>>& a,
+                                    const std::pair<int, std::pair<std::pair<int, int>, std::pair<int, int>>>& b) {
+                                     return a.first > b.first;
+                                 });
+                moves.clear();
+                for (const auto& entry : scored) {
+                    moves.push_back(entry.second);
+                }
+                index = 0;
+                stage = Stage::GOOD_CAPTURES;
+                break;
+            }
+
+            case Stage::GOOD_CAPTURES:
+                if (index < moves.size()) {
+                    move = moves[index++];
+                    return true;
+                }
+                index = 0;
+                stage = Stage::KILLERS;
+                break;
+
+            case Stage::KILLERS:
+                // Killers are quiet moves that cut off a sibling node
+                while (index < 2) {
+                    int killer = killers[index++];
+                    if (killer != hashMove && isLegal(killer)) {
+                        move = unpack(killer);
+                        if (!board.isCaptureMove(move.first.first, move.first.second, move.second.first, move.second.second)) {
+                            return true;
+                        }
+                    }
+                }
+                stage = Stage::GENERATE_QUIETS;
+                break;
+
+            case Stage::GENERATE_QUIETS:
+                moves.clear();
+                board.generateQuietMoves(forWhite, moves);
+                // Checking moves first
+                std::stable_partition(moves.begin(), moves.end(),
+                                      [this](const std::pair<std::pair<int, int>, std::pair<int, int>>& quiet) {
+                                          return board.givesCheck(quiet.first.first, quiet.first.second,
+                                                                  quiet.second.first, quiet.second.second, checkInfo);
+                                      });
+                index = 0;
+                stage = Stage::QUIET_MOVES;
+                break;
+
+            case Stage::QUIET_MOVES:
+                while (index < moves.size()) {
+                    const auto& quiet = moves[index++];
+                    if (!isHashOrKiller(quiet)) {
+                        move = quiet;
+                        return true;
+                    }
+                }
+                index = 0;
+                stage = Stage::BAD_CAPTURES;
+                break;
+
+            case Stage::BAD_CAPTURES:
+                if (index < badCaptures.size()) {
+                    move = badCaptures[index++];
+                    return true;
+                }
+                stage = Stage::DONE;
+                break;
+
+            case Stage::DONE:
+                return false;
+        }
+    }
+}
@@ -0,0 +1,260 @@
+#include "../include/NnueNetwork.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Little-endian readers over the loaded file; advance pos and fail past the end
+bool readBytes(const std::vector<char>& data, size_t& pos, void* out, size_t count) {
+    if (pos + count > data.size()) return false;
+    memcpy(out, data.data() + pos, count);
+    pos += count;
+    return true;
+}
+
+bool readUint32(const std::vector<char>& data, size_t& pos, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!readBytes(data, pos, bytes, 4)) return false;
+    value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool readInt16s(const std::vector<char>& data, size_t& pos, std::vector<int16_t>& values, size_t count) {
+    values.resize(count);
+    for (auto& value : values) {
+        unsigned char bytes[2];
+        if (!readBytes(data, pos, bytes, 2)) return false;
+        value = static_cast<int16_t>(bytes[0] | (bytes[1] << 8));
+    }
+    return true;
+}
+
+bool readInt32s(const std::vector<char>& data, size_t& pos, std::vector<int32_t>& values, size_t count) {
+    values.resize(count);
+    for (auto& value : values) {
+        uint32_t raw;
+        if (!readUint32(data, pos, raw)) return false;
+        value = static_cast<int32_t>(raw);
+    }
+    return true;
+}
+
+// int8 weights are widened so the dense layers can use 16-bit multiply-add
+template <typename T>
+bool readInt8s(const std::vector<char>& data, size_t& pos, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    for (auto& value : values) {
+        int8_t raw;
+        if (!readBytes(data, pos, &raw, 1)) return false;
+        value = raw;
+    }
+    return true;
+}
+
+void addColumn(int16_t* accumulator, const int16_t* column) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= NnueNetwork::HIDDEN; i += 16) {
+        __m256i sum = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + i)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulator + i), sum);
+    }
+#elif defined(__SSE2__)
+    for (; i + 8 <= NnueNetwork::HIDDEN; i += 8) {
+        __m128i sum = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator + i), sum);
+    }
+#endif
+    for (; i < NnueNetwork::HIDDEN; ++i) {
+        accumulator[i] += column[i];
+    }
+}
+
+void subtractColumn(int16_t* accumulator, const int16_t* column) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= NnueNetwork::HIDDEN; i += 16) {
+        __m256i difference = _mm256_sub_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + i)),
+                                              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulator + i), difference);
+    }
+#elif defined(__SSE2__)
+    for (; i + 8 <= NnueNetwork::HIDDEN; i += 8) {
+        __m128i difference = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator + i)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator + i), difference);
+    }
+#endif
+    for (; i < NnueNetwork::HIDDEN; ++i) {
+        accumulator[i] -= column[i];
+    }
+}
+
+// Clipped ReLU to [0, 127]
+void clip(const int16_t* input, int16_t* output, int count) {
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ceiling = _mm256_set1_epi16(127);
+    for (; i + 16 <= count; i += 16) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        value = _mm256_min_epi16(_mm256_max_epi16(value, zero), ceiling);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), value);
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ceiling = _mm_set1_epi16(127);
+    for (; i + 8 <= count; i += 8) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        value = _mm_min_epi16(_mm_max_epi16(value, zero), ceiling);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), value);
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i] = static_cast<int16_t>(std::min<int>(std::max<int>(input[i], 0), 127));
+    }
+}
+
+int32_t dot(const int16_t* a, const int16_t* b, int count) {
+    int i = 0;
+    int32_t total = 0;
+#if defined(__AVX2__)
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 16 <= count; i += 16) {
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i))));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    total = _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+    __m128i sum = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    total = _mm_cvtsi128_si32(sum);
+#endif
+    for (; i < count; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+} // namespace
+
+NnueNetwork::NnueNetwork() : loaded(false), outputBias(0) {}
+
+bool NnueNetwork::load(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Parse into temporaries so a bad file leaves the current network intact
+    size_t pos = 0;
+    char magic[4];
+    uint32_t inputs, hidden, layer1;
+    if (!readBytes(data, pos, magic, 4) || memcmp(magic, "NNU1", 4) != 0 ||
+        !readUint32(data, pos, inputs) || !readUint32(data, pos, hidden) || !readUint32(data, pos, layer1) ||
+        inputs != INPUTS || hidden != HIDDEN || layer1 != LAYER1) {
+        return false;
+    }
+
+    std::vector<int16_t> newFeatureBias, newFeatureWeights, newLayer1Weights;
+    std::vector<int32_t> newLayer1Bias, newOutputBias, newOutputWeights;
+    if (!readInt16s(data, pos, newFeatureBias, HIDDEN) ||
+        !readInt16s(data, pos, newFeatureWeights, static_cast<size_t>(INPUTS) * HIDDEN) ||
+        !readInt32s(data, pos, newLayer1Bias, LAYER1) ||
+        !readInt8s(data, pos, newLayer1Weights, static_cast<size_t>(LAYER1) * 2 * HIDDEN) ||
+        !readInt32s(data, pos, newOutputBias, 1) ||
+        !readInt8s(data, pos, newOutputWeights, LAYER1) ||
+        pos != data.size()) {
+        return false;
+    }
+
+    featureBias.swap(newFeatureBias);
+    featureWeights.swap(newFeatureWeights);
+    layer1Bias.swap(newLayer1Bias);
+    layer1Weights.swap(newLayer1Weights);
+    outputBias = newOutputBias[0];
+    outputWeights.swap(newOutputWeights);
+    path = filePath;
+    loaded = true;
+    return true;
+}
+
+int NnueNetwork::featureIndex(int perspective, char symbol, int x, int y) {
+    int type = 0;
+    switch (toupper(symbol)) {
+        case 'P': type = 0; break;
+        case 'N': type = 1; break;
+        case 'B': type = 2; break;
+        case 'R': type = 3; break;
+        case 'Q': type = 4; break;
+        case 'K': type = 5; break;
+    }
+
+    // Each perspective sees its own pieces as "ours" and its own back rank as rank 1
+    bool white = isupper(symbol) != 0;
+    int owner = (white == (perspective == 0)) ? 0 : 1;
+    int square = (perspective == 0) ? (7 - x) * 8 + y : x * 8 + y;
+    return (type * 2 + owner) * 64 + square;
+}
+
+void NnueNetwork::resetAccumulator(NnueAccumulator& accumulator) const {
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        std::copy(featureBias.begin(), featureBias.end(), accumulator.values[perspective]);
+    }
+}
+
+void NnueNetwork::addPiece(NnueAccumulator& accumulator, char symbol, int x, int y) const {
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        addColumn(accumulator.values[perspective], &featureWeights[featureIndex(perspective, symbol, x, y) * HIDDEN]);
+    }
+}
+
+void NnueNetwork::removePiece(NnueAccumulator& accumulator, char symbol, int x, int y) const {
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        subtractColumn(accumulator.values[perspective], &featureWeights[featureIndex(perspective, symbol, x, y) * HIDDEN]);
+    }
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator) const {
+    // White's half always comes first, so the output is from White's point of view
+    int16_t input[2 * HIDDEN];
+    clip(accumulator.values[0], input, HIDDEN);
+    clip(accumulator.values[1], input + HIDDEN, HIDDEN);
+
+    int32_t output = outputBias;
+    for (int neuron = 0; neuron < LAYER1; ++neuron) {
+        int32_t sum = layer1Bias[neuron] + dot(input, &layer1Weights[neuron * 2 * HIDDEN], 2 * HIDDEN);
+        int32_t activation = std::min(std::max(sum >> LAYER1_SHIFT, 0), 127);
+        output += activation * outputWeights[neuron];
+    }
+    return output / OUTPUT_SCALE;
+}
+
+const char* NnueNetwork::getSimdName() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,155 @@
+#include "../include/OpeningBook.h"
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+const size_t ENTRY_SIZE = 16;
+
+uint64_t readBigEndian(const unsigned char* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void writeBigEndian(uint64_t value, unsigned char* bytes, int count) {
+    for (int i = count - 1; i >= 0; --i) {
+        bytes[i] = static_cast<unsigned char>(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+} // namespace
+
+OpeningBook::OpeningBook() : entryCount(0),
+    rng(static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count())) {}
+
+bool OpeningBook::open(const std::string& bookPath) {
+    close();
+    if (!file.open(bookPath)) {
+        return false;
+    }
+    path = bookPath;
+    entryCount = file.size() / ENTRY_SIZE;
+    return true;
+}
+
+void OpeningBook::close() {
+    file.close();
+    path.clear();
+    entryCount = 0;
+}
+
+BookEntry OpeningBook::readEntry(const unsigned char* bytes) {
+    BookEntry entry;
+    entry.key = readBigEndian(bytes, 8);
+    entry.move = static_cast<uint16_t>(readBigEndian(bytes + 8, 2));
+    entry.weight = static_cast<uint16_t>(readBigEndian(bytes + 10, 2));
+    entry.learn = static_cast<uint32_t>(readBigEndian(bytes + 12, 4));
+    return entry;
+}
+
+void OpeningBook::writeEntry(const BookEntry& entry, unsigned char* bytes) {
+    writeBigEndian(entry.key, bytes, 8);
+    writeBigEndian(entry.move, bytes + 8, 2);
+    writeBigEndian(entry.weight, bytes + 10, 2);
+    writeBigEndian(entry.learn, bytes + 12, 4);
+}
+
+size_t OpeningBook::lowerBound(uint64_t key) const {
+    // Entries are sorted by key; binary search straight on the mapped bytes
+    size_t low = 0;
+    size_t high = entryCount;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (readBigEndian(file.data() + mid * ENTRY_SIZE, 8) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+std::vector<BookEntry> OpeningBook::getEntries(uint64_t key) const {
+    std::vector<BookEntry> entries;
+    if (!isOpen()) {
+        return entries;
+    }
+
+    for (size_t i = lowerBound(key); i < entryCount; ++i) {
+        BookEntry entry = readEntry(file.data() + i * ENTRY_SIZE);
+        if (entry.key != key) {
+            break;
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+bool OpeningBook::probe(const Board& board, bool whiteToMove, std::pair<std::pair<int, int>, std::pair<int, int>>& move) {
+    auto entries = getEntries(board.getZobristKey(whiteToMove));
+
+    uint32_t totalWeight = 0;
+    for (const auto& entry : entries) {
+        totalWeight += entry.weight;
+    }
+    if (totalWeight == 0) {
+        return false;
+    }
+
+    std::uniform_int_distribution<uint32_t> dis(0, totalWeight - 1);
+    uint32_t pick = dis(rng);
+    for (const auto& entry : entries) {
+        if (pick < entry.weight) {
+            move = decodeMove(board, entry.move);
+            // Guard against key collisions and corrupt books
+            return move.first.first != -1 &&
+                   board.getPiece(move.first.first, move.first.second) &&
+                   board.getPiece(move.first.first, move.first.second)->isWhite() == whiteToMove &&
+                   board.isValidMove(move.first.first, move.first.second, move.second.first, move.second.second);
+        }
+        pick -= entry.weight;
+    }
+    return false;
+}
+
+uint16_t OpeningBook::encodeMove(const Board& board, int x1, int y1, int x2, int y2) {
+    // Polyglot writes castling as the king capturing its own rook
+    Piece* piece = board.getPiece(x1, y1);
+    if (piece && toupper(piece->getSymbol()) == 'K' && y1 == 4 && abs(y2 - y1) == 2) {
+        y2 = (y2 > y1) ? 7 : 0;
+    }
+
+    int promotion = 0;
+    if (piece && toupper(piece->getSymbol()) == 'P' && (x2 == 0 || x2 == 7)) {
+        promotion = 4; // Pawns always promote to a queen
+    }
+
+    int fromRow = 7 - x1;
+    int toRow = 7 - x2;
+    return static_cast<uint16_t>((promotion << 12) | (fromRow << 9) | (y1 << 6) | (toRow << 3) | y2);
+}
+
+std::pair<std::pair<int, int>, std::pair<int, int>> OpeningBook::decodeMove(const Board& board, uint16_t move) {
+    int toFile = move & 7;
+    int toRow = (move >> 3) & 7;
+    int fromFile = (move >> 6) & 7;
+    int fromRow = (move >> 9) & 7;
+
+    int x1 = 7 - fromRow;
+    int y1 = fromFile;
+    int x2 = 7 - toRow;
+    int y2 = toFile;
+
+    // King-takes-rook castling back to the king's two-square move
+    Piece* piece = board.getPiece(x1, y1);
+    if (piece && toupper(piece->getSymbol()) == 'K' && x1 == x2 && y1 == 4 && (y2 == 7 || y2 == 0)) {
+        y2 = (y2 == 7) ? 6 : 2;
+    }
+
+    return {{x1, y1}, {x2, y2}};
+}
@@ -0,0 +1,43 @@
+#include "../include/PawnHashTable.h"
+
+PawnHashTable::PawnHashTable(size_t sizeKB) : mask(0) {
+    resize(sizeKB);
+}
+
+void PawnHashTable::resize(size_t sizeKB) {
+    // Round the entry count down to a power of two so indexing is a mask
+    size_t count = (sizeKB * 1024) / sizeof(PawnEntry);
+    size_t size = 1;
+    while (size * 2 <= count) {
+        size *= 2;
+    }
+    entries.assign(size, PawnEntry());
+    mask = size - 1;
+    clear();
+}
+
+void PawnHashTable::clear() {
+    for (auto &entry : entries) {
+        entry.key = 0;
+        entry.midgame = 0;
+        entry.endgame = 0;
+        entry.valid = false;
+    }
+}
+
+bool PawnHashTable::probe(uint64_t key, PawnEntry& entry) const {
+    const PawnEntry& slot = entries[key & mask];
+    if (!slot.valid || slot.key != key) {
+        return false;
+    }
+    entry = slot;
+    return true;
+}
+
+void PawnHashTable::store(uint64_t key, int midgame, int endgame) {
+    PawnEntry& slot = entries[key & mask];
+    slot.key = key;
+    slot.midgame = midgame;
+    slot.endgame = endgame;
+    slot.valid = true;
+}
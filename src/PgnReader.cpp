@@ -0,0 +1,228 @@
+#include "../include/PgnReader.h"
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Characters that end a movetext token besides white space
+bool endsToken(char c) {
+    return isBlank(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == ';' || c == '[' || c == '$';
+}
+
+bool isTermination(const std::string& token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// Coordinate moves such as "e2e4" or "e7e8q", as earlier exports of this game wrote them
+std::pair<std::pair<int, int>, std::pair<int, int>> parseCoordinateMove(const Board& board, const std::string& token,
+                                                                        bool whiteToMove) {
+    const std::pair<std::pair<int, int>, std::pair<int, int>> invalid = {{-1, -1}, {-1, -1}};
+    if (token.length() < 4 || token.length() > 5 || token[0] < 'a' || token[0] > 'h' || token[1] < '1' || token[1] > '8' ||
+        token[2] < 'a' || token[2] > 'h' || token[3] < '1' || token[3] > '8') {
+        return invalid;
+    }
+    int x1 = 8 - (token[1] - '0');
+    int y1 = token[0] - 'a';
+    int x2 = 8 - (token[3] - '0');
+    int y2 = token[2] - 'a';
+    Piece* piece = board.getPiece(x1, y1);
+    if (!piece || piece->isWhite() != whiteToMove || !board.isValidMove(x1, y1, x2, y2)) {
+        return invalid;
+    }
+    return {{x1, y1}, {x2, y2}};
+}
+
+} // namespace
+
+std::string PgnGame::getTag(const std::string& name) const {
+    for (const auto& tag : tags) {
+        if (tag.first == name) {
+            return tag.second;
+        }
+    }
+    return "";
+}
+
+PgnReader::PgnReader() : begin(nullptr), cursor(nullptr), end(nullptr) {}
+
+bool PgnReader::open(const std::string& path) {
+    if (!file.open(path)) {
+        setText(nullptr, nullptr);
+        return false;
+    }
+    const char* text = reinterpret_cast<const char*>(file.data());
+    setText(text, text + file.size());
+
+    // Skip a UTF-8 byte order mark
+    if (end - cursor >= 3 && memcmp(cursor, "\xEF\xBB\xBF", 3) == 0) {
+        cursor += 3;
+    }
+    return true;
+}
+
+void PgnReader::setText(const char* textBegin, const char* textEnd) {
+    begin = textBegin;
+    cursor = textBegin;
+    end = textEnd;
+}
+
+bool PgnReader::next(PgnGame& game) {
+    game.tags.clear();
+    game.startFEN.clear();
+    game.moves.clear();
+    game.result.clear();
+    game.error.clear();
+
+    // Tag pairs, up to the first movetext character
+    while (cursor < end) {
+        char c = *cursor;
+        if (isBlank(c)) {
+            ++cursor;
+        } else if (c == '%' && (cursor == begin || cursor[-1] == '\n')) {
+            skipLine(); // Escape line
+        } else if (c == '[') {
+            readTag(game);
+        } else {
+            break;
+        }
+    }
+    if (cursor >= end && game.tags.empty()) {
+        return false;
+    }
+
+    readMovetext(game);
+    return true;
+}
+
+void PgnReader::skipLine() {
+    const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+    cursor = newline ? newline + 1 : end;
+}
+
+// [Name "Value"], the value possibly holding \" and \\ escapes
+void PgnReader::readTag(PgnGame& game) {
+    ++cursor;
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) ++cursor;
+    const char* nameBegin = cursor;
+    while (cursor < end && !isBlank(*cursor) && *cursor != '"' && *cursor != ']') ++cursor;
+    std::string name(nameBegin, cursor);
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) ++cursor;
+
+    std::string value;
+    if (cursor < end && *cursor == '"') {
+        ++cursor;
+        while (cursor < end && *cursor != '"' && *cursor != '\n') {
+            if (*cursor == '\\' && cursor + 1 < end && (cursor[1] == '"' || cursor[1] == '\\')) {
+                ++cursor;
+            }
+            value += *cursor++;
+        }
+    }
+    skipLine(); // Whatever follows the closing bracket
+
+    if (name.empty()) {
+        return;
+    }
+    if (name == "FEN") {
+        game.startFEN = value;
+    }
+    game.tags.push_back({name, value});
+}
+
+void PgnReader::readMovetext(PgnGame& game) {
+    Board board;
+    bool whiteToMove = true;
+    int fullmoveNumber = 1;
+    if (!game.startFEN.empty() && !board.loadFEN(game.startFEN, whiteToMove, fullmoveNumber)) {
+        game.error = "Invalid FEN " + game.startFEN;
+    }
+
+    int depth = 0; // Variation nesting
+    std::string token;
+    while (cursor < end) {
+        char c = *cursor;
+        if (isBlank(c)) {
+            ++cursor;
+            continue;
+        }
+        if (c == '{') {
+            const char* close = static_cast<const char*>(memchr(cursor, '}', end - cursor));
+            cursor = close ? close + 1 : end;
+            continue;
+        }
+        if (c == ';' || (c == '%' && (cursor == begin || cursor[-1] == '\n'))) {
+            skipLine();
+            continue;
+        }
+        if (c == '(') {
+            ++depth;
+            ++cursor;
+            continue;
+        }
+        if (c == ')' || c == '}') {
+            if (c == ')' && depth > 0) --depth; // A stray '}' is dropped
+            ++cursor;
+            continue;
+        }
+        if (c == '$') {
+            ++cursor;
+            while (cursor < end && isdigit(static_cast<unsigned char>(*cursor))) ++cursor;
+            continue;
+        }
+        if (c == '[') {
+            break; // Next game's tags: this one had no termination marker
+        }
+
+        const char* tokenBegin = cursor;
+        while (cursor < end && !endsToken(*cursor)) ++cursor;
+        if (depth > 0) {
+            continue;
+        }
+        token.assign(tokenBegin, cursor);
+        if (isTermination(token)) {
+            game.result = token;
+            break;
+        }
+
+        // Drop a move number ("12.", "12...") glued to the move; "0-0" has no dot
+        size_t digits = 0;
+        while (digits < token.length() && isdigit(static_cast<unsigned char>(token[digits]))) ++digits;
+        size_t start = digits;
+        while (start < token.length() && token[start] == '.') ++start;
+        if (start == digits && digits > 0) {
+            start = digits == token.length() ? digits : 0; // Bare move number, or a move
+        }
+        if (start == token.length() || !game.error.empty()) {
+            continue;
+        }
+        if (start > 0) {
+            token.erase(0, start);
+        }
+
+        // "e2e4" would read as a pawn push with disambiguation, so coordinates go first
+        auto move = parseCoordinateMove(board, token, whiteToMove);
+        if (move.first.first == -1) {
+            move = board.parseSAN(token, whiteToMove);
+        }
+        if (move.first.first == -1) {
+            // Pawns only promote to a queen here, so such a game cannot be replayed
+            game.error = (Board::isUnderPromotion(token) ? "Unsupported under-promotion " : "Illegal or unreadable move ") +
+                         token + " at ply " + std::to_string(game.moves.size() + 1);
+            continue;
+        }
+        board.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+        game.moves.push_back(move);
+        whiteToMove = !whiteToMove;
+    }
+
+    if (game.result.empty()) {
+        game.result = game.getTag("Result");
+        if (game.result.empty()) {
+            game.result = "*";
+        }
+    }
+}
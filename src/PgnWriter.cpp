@@ -0,0 +1,126 @@
+#include "../include/PgnWriter.h"
+
+namespace {
+
+// Tag values escape their quotes and backslashes
+void appendTag(std::string& text, const std::string& name, const std::string& value) {
+    text += '[';
+    text += name;
+    text += " \"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') text += '\\';
+        text += c;
+    }
+    text += "\"]\n";
+}
+
+} // namespace
+
+PgnWriter::PgnWriter() {}
+
+PgnWriter::~PgnWriter() {
+    close();
+}
+
+bool PgnWriter::open(const std::string& path, bool append) {
+    close();
+    file.open(path, append ? std::ios::binary | std::ios::app : std::ios::binary | std::ios::trunc);
+    return file.is_open();
+}
+
+void PgnWriter::close() {
+    if (file.is_open()) {
+        flush();
+        file.close();
+    }
+}
+
+bool PgnWriter::write(const PgnGame& game, const std::string& comment) {
+    size_t start = buffer.size();
+    if (!format(game, comment, buffer)) {
+        buffer.resize(start);
+        return false;
+    }
+    if (buffer.size() >= FLUSH_SIZE) {
+        flush();
+    }
+    return true;
+}
+
+bool PgnWriter::flush() {
+    if (!buffer.empty()) {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+bool PgnWriter::format(const PgnGame& game, const std::string& comment, std::string& text) {
+    Board board;
+    bool whiteToMove = true;
+    int fullmoveNumber = 1;
+    if (!game.startFEN.empty() && !board.loadFEN(game.startFEN, whiteToMove, fullmoveNumber)) {
+        return false;
+    }
+
+    bool hasResult = false;
+    bool hasFEN = false;
+    for (const auto& tag : game.tags) {
+        if (tag.first == "Result") {
+            appendTag(text, tag.first, game.result);
+            hasResult = true;
+        } else {
+            appendTag(text, tag.first, tag.second);
+            hasFEN = hasFEN || tag.first == "FEN";
+        }
+    }
+    if (!hasResult) {
+        appendTag(text, "Result", game.result);
+    }
+    if (!game.startFEN.empty() && !hasFEN) {
+        appendTag(text, "SetUp", "1");
+        appendTag(text, "FEN", game.startFEN);
+    }
+    text += '\n';
+
+    // A move stays on the line of its move number
+    std::string line;
+    auto append = [&](const std::string& token) {
+        if (!line.empty() && line.size() + token.size() + 1 > 79) {
+            text += line;
+            text += '\n';
+            line.clear();
+        }
+        if (!line.empty()) line += ' ';
+        line += token;
+    };
+    for (size_t i = 0; i < game.moves.size(); ++i) {
+        const auto& move = game.moves[i];
+        Piece* piece = board.getPiece(move.first.first, move.first.second);
+        if (!piece || piece->isWhite() != whiteToMove ||
+            !board.isValidMove(move.first.first, move.first.second, move.second.first, move.second.second)) {
+            return false;
+        }
+
+        std::string token;
+        if (whiteToMove) {
+            token = std::to_string(fullmoveNumber) + ". ";
+        } else if (i == 0) {
+            token = std::to_string(fullmoveNumber) + "... ";
+        }
+        token += board.toSAN(move.first.first, move.first.second, move.second.first, move.second.second);
+        append(token);
+
+        board.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+        if (!whiteToMove) fullmoveNumber++;
+        whiteToMove = !whiteToMove;
+    }
+    if (!comment.empty()) {
+        append("{" + comment + "}");
+    }
+    append(game.result.empty() ? "*" : game.result);
+    text += line;
+    text += "\n\n";
+    return true;
+}
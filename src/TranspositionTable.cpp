@@ -0,0 +1,51 @@
+#include "../include/TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t sizeMB) : mask(0) {
+    resize(sizeMB);
+}
+
+void TranspositionTable::resize(size_t sizeMB) {
+    // Round the entry count down to a power of two so indexing is a mask
+    size_t count = (sizeMB * 1024 * 1024) / sizeof(TTEntry);
+    size_t size = 1;
+    while (size * 2 <= count) {
+        size *= 2;
+    }
+    entries.assign(size, TTEntry());
+    mask = size - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (auto &entry : entries) {
+        entry.key = 0;
+        entry.score = 0;
+        entry.depth = -1;
+        entry.bestMove = -1;
+        entry.flag = TTFlag::NONE;
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const TTEntry& slot = entries[key & mask];
+    if (slot.flag == TTFlag::NONE || slot.key != key) {
+        return false;
+    }
+    entry = slot;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, TTFlag flag, int bestMove) {
+    TTEntry& slot = entries[key & mask];
+
+    // Depth-preferred replacement, but always replace entries of other positions
+    if (slot.key == key && slot.flag != TTFlag::NONE && slot.depth > depth) {
+        return;
+    }
+
+    slot.key = key;
+    slot.score = score;
+    slot.depth = depth;
+    slot.flag = flag;
+    slot.bestMove = bestMove;
+}
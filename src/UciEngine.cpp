@@ -0,0 +1,210 @@
+#include "../include/UciEngine.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const char* const START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+bool isPromotion(const Board& board, const std::pair<std::pair<int, int>, std::pair<int, int>>& move) {
+    Piece* piece = board.getPiece(move.first.first, move.first.second);
+    return piece && toupper(piece->getSymbol()) == 'P' && (move.second.first == 0 || move.second.first == 7);
+}
+
+} // namespace
+
+UciEngine::UciEngine() : whiteToMove(true), infinite(false), stopRequested(false) {}
+
+UciEngine::~UciEngine() {
+    stopSearch();
+}
+
+void UciEngine::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+void UciEngine::run() {
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream iss(line);
+        std::string command;
+        iss >> command;
+        std::string arguments;
+        std::getline(iss, arguments);
+        
+        if (command == "uci") {
+            send("id name Chess Game in C++");
+            send("id author Chess Game contributors");
+            send("uciok");
+        } else if (command == "isready") {
+            send("readyok");
+        } else if (command == "ucinewgame") {
+            stopSearch();
+            game.clearSearchTables();
+        } else if (command == "position") {
+            stopSearch();
+            setPosition(arguments);
+        } else if (command == "go") {
+            stopSearch();
+            go(arguments);
+        } else if (command == "stop") {
+            stopSearch();
+        } else if (command == "quit") {
+            break;
+        }
+    }
+    stopSearch();
+}
+
+void UciEngine::setPosition(const std::string& arguments) {
+    std::istringstream iss(arguments);
+    std::string token;
+    iss >> token;
+    
+    std::string fen;
+    if (token == "startpos") {
+        fen = START_FEN;
+        iss >> token;
+    } else if (token == "fen") {
+        while (iss >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    } else {
+        return;
+    }
+    
+    int fullmoveNumber;
+    if (!position.loadFEN(fen, whiteToMove, fullmoveNumber)) {
+        send("info string invalid fen: " + fen);
+        position.loadFEN(START_FEN, whiteToMove, fullmoveNumber);
+        return;
+    }
+    
+    // The moves are played on a copy and kept only if every one of them is legal,
+    // so a bad list leaves the FEN position rather than a half-played one
+    if (token == "moves") {
+        Board played = position;
+        bool playedWhiteToMove = whiteToMove;
+        while (iss >> token) {
+            std::pair<std::pair<int, int>, std::pair<int, int>> move;
+            if (!uciToMove(played, playedWhiteToMove, token, move)) {
+                send("info string illegal move: " + token);
+                return;
+            }
+            played.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+            playedWhiteToMove = !playedWhiteToMove;
+        }
+        position = played;
+        whiteToMove = playedWhiteToMove;
+    }
+}
+
+void UciEngine::go(const std::string& arguments) {
+    std::istringstream iss(arguments);
+    std::string token;
+    SearchLimits limits;
+    int whiteTime = 0, blackTime = 0, whiteIncrement = 0, blackIncrement = 0, movesToGo = 0;
+    bool isInfinite = false;
+    while (iss >> token) {
+        if (token == "depth") iss >> limits.depth;
+        else if (token == "movetime") iss >> limits.moveTime;
+        else if (token == "nodes") iss >> limits.nodes;
+        else if (token == "wtime") iss >> whiteTime;
+        else if (token == "btime") iss >> blackTime;
+        else if (token == "winc") iss >> whiteIncrement;
+        else if (token == "binc") iss >> blackIncrement;
+        else if (token == "movestogo") iss >> movesToGo;
+        else if (token == "infinite") isInfinite = true;
+    }
+    
+    // With only a clock, spend an even share of what is left plus most of the increment
+    int timeLeft = whiteToMove ? whiteTime : blackTime;
+    if (limits.moveTime == 0 && timeLeft > 0) {
+        int increment = whiteToMove ? whiteIncrement : blackIncrement;
+        int share = timeLeft / (movesToGo > 0 ? movesToGo + 1 : 30) + increment * 3 / 4;
+        limits.moveTime = std::max(1, std::min(share, timeLeft - 50));
+    }
+    
+    infinite = isInfinite;
+    stopRequested = false;
+    Board root = position;
+    bool side = whiteToMove;
+    searchThread = std::thread([this, root, side, limits]() {
+        auto best = game.searchPosition(root, side, limits,
+            [this, root, side](const SearchStats& stats, int score,
+                         const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& pv) {
+                // UCI scores are from the side to move's point of view
+                int relative = side ? score : -score;
+                std::ostringstream info;
+                info << "info depth " << stats.depth << " seldepth " << stats.selectiveDepth << " score ";
+                if (Game::mateDistance(relative) != 0) {
+                    info << "mate " << Game::mateDistance(relative);
+                } else {
+                    info << "cp " << relative;
+                }
+                info << " nodes " << stats.nodes << " nps " << stats.nodesPerSecond()
+                     << " time " << static_cast<long long>(stats.seconds * 1000) << " pv";
+                // Replayed so each move is written for the position it is played in
+                Board line = root;
+                for (const auto& move : pv) {
+                    info << " " << moveToUci(line, move);
+                    line.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+                }
+                send(info.str());
+            });
+        
+        // "go infinite" must not answer before "stop"
+        while (infinite && !stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        send("bestmove " + (best.first.first == -1 ? std::string("0000") : moveToUci(root, best)));
+    });
+}
+
+void UciEngine::stopSearch() {
+    if (!searchThread.joinable()) {
+        return;
+    }
+    stopRequested = true;
+    game.setSearchStopped(true);
+    searchThread.join();
+    game.setSearchStopped(false);
+}
+
+std::string UciEngine::moveToUci(const Board& board, const std::pair<std::pair<int, int>, std::pair<int, int>>& move) {
+    std::string text;
+    text += static_cast<char>('a' + move.first.second);
+    text += static_cast<char>('0' + (8 - move.first.first));
+    text += static_cast<char>('a' + move.second.second);
+    text += static_cast<char>('0' + (8 - move.second.first));
+    if (isPromotion(board, move)) {
+        text += 'q';
+    }
+    return text;
+}
+
+bool UciEngine::uciToMove(const Board& board, bool whiteToMove, const std::string& text,
+                          std::pair<std::pair<int, int>, std::pair<int, int>>& move) {
+    if (text.size() < 4 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8' ||
+        text[2] < 'a' || text[2] > 'h' || text[3] < '1' || text[3] > '8') {
+        return false;
+    }
+    
+    move = {{8 - (text[1] - '0'), text[0] - 'a'}, {8 - (text[3] - '0'), text[2] - 'a'}};
+    Piece* piece = board.getPiece(move.first.first, move.first.second);
+    if (!piece || piece->isWhite() != whiteToMove ||
+        !board.isValidMove(move.first.first, move.first.second, move.second.first, move.second.second)) {
+        return false;
+    }
+    
+    // Pawns always promote to a queen, so any other promotion piece would leave the
+    // board out of step with the GUI's; a suffix on a move that does not promote is an error too
+    if (isPromotion(board, move)) {
+        return text.size() == 4 || (text.size() == 5 && text[4] == 'q');
+    }
+    return text.size() == 4;
+}
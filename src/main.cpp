@@ -1,8 +1,16 @@
 #include "../include/Game.h"
+#include "../include/UciEngine.h"
 #include <iostream>
 #include <string>
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Headless engine mode for chess GUIs and match runners
+    if (argc > 1 && std::string(argv[1]) == "--uci") {
+        UciEngine engine;
+        engine.run();
+        return 0;
+    }
+    
     std::cout << "=== CHESS GAME WITH AI ===\n\n";
     
     // Game mode selection
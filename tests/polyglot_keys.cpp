@@ -0,0 +1,57 @@
+// polyglot_keys: checks Board::getZobristKey against the reference keys in the
+// Polyglot book format specification, so books built by bookgen or by other
+// tools find the same positions.
+//
+// Usage: polyglot_keys (exit status 0 when every key matches)
+
+#include "../include/Board.h"
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct KeyCase {
+    const char* fen;
+    uint64_t key;
+};
+
+const KeyCase CASES[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463b96181691fc9cULL},
+    {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196ULL},
+    {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0ULL},
+    {"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4ULL},
+    {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78ULL},
+    {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1ULL},
+    {"rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9ULL},
+    {"rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637ULL},
+    {"rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560ULL},
+};
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    for (const KeyCase& test : CASES) {
+        Board board;
+        bool whiteToMove = true;
+        int fullmoveNumber = 1;
+        if (!board.loadFEN(test.fen, whiteToMove, fullmoveNumber)) {
+            std::cout << "FAIL " << test.fen << ": FEN does not load\n";
+            failures++;
+            continue;
+        }
+        uint64_t key = board.getZobristKey(whiteToMove);
+        if (key != test.key) {
+            std::cout << "FAIL " << test.fen << ": key " << std::hex << std::setw(16) << std::setfill('0') << key
+                      << ", expected " << std::setw(16) << test.key << std::dec << "\n";
+            failures++;
+        }
+    }
+    if (failures > 0) {
+        std::cout << failures << " of " << sizeof(CASES) / sizeof(CASES[0]) << " keys differ\n";
+        return 1;
+    }
+    std::cout << "All " << sizeof(CASES) / sizeof(CASES[0]) << " keys match\n";
+    return 0;
+}
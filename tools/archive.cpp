@@ -0,0 +1,151 @@
+// archive: builds and reads binary game archives (.chess files).
+//
+// pack converts a PGN database into an archive, or adds its games to an
+// existing one with --append; games whose movetext cannot be replayed are
+// left out. scan decodes every game of an archive and reports how fast, and
+// show prints one game, found through the archive's index, as PGN.
+//
+// Usage: archive pack <games.pgn> <games.chess> [--append]
+//        archive scan <games.chess>
+//        archive show <games.chess> <N>
+
+#include "../include/GameArchive.h"
+#include "../include/PgnReader.h"
+#include "../include/PgnWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+
+uint64_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<uint64_t>(file.tellg()) : 0;
+}
+
+int pack(const std::string& input, const std::string& output, bool append) {
+    PgnReader reader;
+    if (!reader.open(input)) {
+        std::cout << "Error: Could not open file " << input << " for reading.\n";
+        return 1;
+    }
+    GameArchiveWriter writer;
+    if (!writer.open(output, append)) {
+        std::cout << "Error: Could not open file " << output << " for writing, or it is not a game archive.\n";
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    size_t existing = writer.getGameCount();
+    uint64_t games = 0;
+    uint64_t skipped = 0;
+    PgnGame game;
+    while (reader.next(game)) {
+        games++;
+        if (!game.isValid() || !writer.write(game)) {
+            skipped++;
+        }
+    }
+    if (!writer.close()) {
+        std::cout << "Error: Could not write " << output << ".\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    uint64_t pgnBytes = reader.getBytesRead();
+    uint64_t archiveBytes = fileSize(output);
+    std::cout << "Games: " << games - skipped << " packed, " << skipped << " skipped with unreadable movetext";
+    if (existing > 0) {
+        std::cout << ", " << existing << " already in the archive";
+    }
+    std::cout << "\n";
+    std::cout << "Size: " << pgnBytes << " bytes of PGN, archive now " << archiveBytes << " bytes\n";
+    std::cout << "Time: " << seconds << "s (" << static_cast<uint64_t>(games / std::max(seconds, 1e-9)) << " games/s)\n";
+    return 0;
+}
+
+int scan(const std::string& input) {
+    GameArchive archive;
+    if (!archive.open(input)) {
+        std::cout << "Error: Could not open file " << input << " for reading, or it is not a game archive.\n";
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    PgnGame game;
+    uint64_t errors = 0;
+    uint64_t plies = 0;
+    std::map<std::string, uint64_t> results;
+    for (size_t i = 0; i < archive.size(); ++i) {
+        archive.readGame(i, game);
+        plies += game.moves.size();
+        results[game.result]++;
+        if (!game.isValid()) {
+            if (errors < 10) {
+                std::cout << "Game " << i + 1 << ": " << game.error << "\n";
+            }
+            errors++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "Games: " << archive.size() << " (" << errors << " damaged)\n";
+    std::cout << "Plies: " << plies << "\n";
+    std::cout << "Results:";
+    for (const auto& result : results) {
+        std::cout << " " << result.first << " " << result.second;
+    }
+    std::cout << "\n";
+    std::cout << "Time: " << seconds << "s (" << static_cast<uint64_t>(archive.size() / std::max(seconds, 1e-9))
+              << " games/s)\n";
+    return 0;
+}
+
+int show(const std::string& input, const std::string& number) {
+    GameArchive archive;
+    if (!archive.open(input)) {
+        std::cout << "Error: Could not open file " << input << " for reading, or it is not a game archive.\n";
+        return 1;
+    }
+    size_t index = number.find_first_not_of("0123456789") == std::string::npos && number.size() < 10 ? std::stoul(number) : 0;
+    PgnGame game;
+    if (index == 0 || !archive.readGame(index - 1, game)) {
+        std::cout << "Error: " << input << " holds " << archive.size() << " games.\n";
+        return 1;
+    }
+
+    std::string text;
+    if (!PgnWriter::format(game, game.isValid() ? "" : game.error, text)) {
+        std::cout << "Error: Game " << index << " does not replay.\n";
+        return 1;
+    }
+    std::cout << text;
+    return game.isValid() ? 0 : 1;
+}
+
+void printUsage() {
+    std::cout << "Usage: archive pack <games.pgn> <games.chess> [--append]\n"
+              << "       archive scan <games.chess>\n"
+              << "       archive show <games.chess> <N>\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "pack" && (argc == 4 || (argc == 5 && std::string(argv[4]) == "--append"))) {
+        return pack(argv[2], argv[3], argc == 5);
+    }
+    if (command == "scan" && argc == 3) {
+        return scan(argv[2]);
+    }
+    if (command == "show" && argc == 4) {
+        return show(argv[2], argv[3]);
+    }
+    printUsage();
+    return 1;
+}
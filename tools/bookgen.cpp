@@ -0,0 +1,421 @@
+// bookgen: builds a Polyglot-format opening book from PGN game collections.
+//
+// The PGN file is memory-mapped and split into one chunk per thread at game
+// boundaries. Each thread replays its games up to a ply limit and counts
+// (position key, move) results in a hash map. When a map grows past the run
+// size it is sorted and spilled to a temporary run file, so memory stays
+// bounded however many games are read. The runs are merged at the end into a
+// sorted book.
+//
+// Usage: bookgen <games.pgn> <book.bin> [--plies N] [--threads N] [--min-games N] [--run-size N]
+
+#include "../include/Board.h"
+#include "../include/MappedFile.h"
+#include "../include/OpeningBook.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct BookKey {
+    uint64_t key;
+    uint16_t move;
+    bool operator==(const BookKey& other) const { return key == other.key && move == other.move; }
+};
+
+struct BookKeyHash {
+    size_t operator()(const BookKey& k) const { return static_cast<size_t>(k.key ^ (static_cast<uint64_t>(k.move) * 0x9E3779B97F4A7C15ULL)); }
+};
+
+// Results from the point of view of the side that played the move
+struct MoveCounts {
+    uint32_t games = 0;
+    uint32_t wins = 0;
+    uint32_t draws = 0;
+    uint32_t losses = 0;
+};
+
+// Fixed-size record used in the temporary run files
+struct RunRecord {
+    uint64_t key;
+    uint16_t move;
+    MoveCounts counts;
+};
+
+bool recordLess(const RunRecord& a, const RunRecord& b) {
+    return a.key != b.key ? a.key < b.key : a.move < b.move;
+}
+
+struct Options {
+    std::string input;
+    std::string output;
+    int plies = 20;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    uint32_t minGames = 1;
+    size_t runSize = 1000000; // Map entries per thread before spilling a run
+};
+
+class RunSpiller {
+public:
+    explicit RunSpiller(const std::string& prefix) : prefix(prefix) {}
+
+    void spill(std::unordered_map<BookKey, MoveCounts, BookKeyHash>& counts) {
+        if (counts.empty()) return;
+
+        std::vector<RunRecord> records;
+        records.reserve(counts.size());
+        for (const auto& item : counts) {
+            RunRecord record;
+            record.key = item.first.key;
+            record.move = item.first.move;
+            record.counts = item.second;
+            records.push_back(record);
+        }
+        counts.clear();
+        std::sort(records.begin(), records.end(), recordLess);
+
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            path = prefix + ".run" + std::to_string(paths.size());
+            paths.push_back(path);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(RunRecord));
+    }
+
+    const std::vector<std::string>& getPaths() const { return paths; }
+
+private:
+    std::string prefix;
+    std::mutex mutex;
+    std::vector<std::string> paths;
+};
+
+// Removes "12." / "12..." move-number prefixes glued to a token
+std::string stripMoveNumber(const std::string& token) {
+    size_t i = 0;
+    while (i < token.length() && isdigit(static_cast<unsigned char>(token[i]))) ++i;
+    if (i == 0 || i == token.length() || token[i] != '.') return token;
+    while (i < token.length() && token[i] == '.') ++i;
+    return token.substr(i);
+}
+
+class GameReplayer {
+public:
+    GameReplayer(const Options& options, RunSpiller& spiller) : options(options), spiller(spiller), games(0), positions(0) {}
+
+    void parseChunk(const char* begin, const char* end) {
+        std::string result;
+        std::string movetext;
+        bool hasSetup = false;
+        bool inMoves = false;
+
+        const char* line = begin;
+        while (line < end) {
+            const char* lineEnd = static_cast<const char*>(memchr(line, '\n', end - line));
+            if (!lineEnd) lineEnd = end;
+
+            if (line < lineEnd && *line == '[') {
+                if (inMoves) {
+                    finishGame(movetext, result, hasSetup);
+                    movetext.clear();
+                    result.clear();
+                    hasSetup = false;
+                    inMoves = false;
+                }
+                std::string tag(line, lineEnd);
+                if (tag.compare(0, 8, "[Result ") == 0) {
+                    size_t open = tag.find('"');
+                    size_t close = tag.rfind('"');
+                    if (open != std::string::npos && close > open) {
+                        result = tag.substr(open + 1, close - open - 1);
+                    }
+                } else if (tag.compare(0, 5, "[FEN ") == 0) {
+                    hasSetup = true;
+                }
+            } else if (line < lineEnd && *line != '%') {
+                // Rest-of-line comments end at the newline we are about to drop
+                const char* comment = static_cast<const char*>(memchr(line, ';', lineEnd - line));
+                inMoves = true;
+                movetext.append(line, comment ? comment : lineEnd);
+                movetext += ' ';
+            }
+            line = lineEnd + 1;
+        }
+        if (inMoves) {
+            finishGame(movetext, result, hasSetup);
+        }
+        spiller.spill(counts);
+    }
+
+    uint64_t getGames() const { return games; }
+    uint64_t getPositions() const { return positions; }
+
+private:
+    const Options& options;
+    RunSpiller& spiller;
+    std::unordered_map<BookKey, MoveCounts, BookKeyHash> counts;
+    uint64_t games;
+    uint64_t positions;
+
+    void finishGame(const std::string& movetext, const std::string& result, bool hasSetup) {
+        // Games from set-up positions do not belong in an opening book
+        if (hasSetup) return;
+
+        Board board;
+        bool whiteToMove = true;
+        int ply = 0;
+        int depth = 0; // Variation nesting
+        std::string token;
+
+        for (size_t i = 0; i <= movetext.length() && ply < options.plies; ++i) {
+            char c = i < movetext.length() ? movetext[i] : ' ';
+
+            bool delimiter = isspace(static_cast<unsigned char>(c)) || c == '{' || c == '(' || c == ')';
+            if (!delimiter) {
+                token += c;
+                continue;
+            }
+
+            // Finish the pending token before the delimiter changes the nesting
+            std::string san = (depth == 0) ? stripMoveNumber(token) : std::string();
+            token.clear();
+            if (c == '{') {
+                size_t close = movetext.find('}', i);
+                i = (close == std::string::npos) ? movetext.length() : close;
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')') {
+                depth = std::max(0, depth - 1);
+            }
+            if (san.empty() || san[0] == '$' || san == "*" || san == "1-0" || san == "0-1" || san == "1/2-1/2") {
+                continue;
+            }
+
+            auto move = board.parseSAN(san, whiteToMove);
+            if (move.first.first == -1) {
+                return; // Unreadable move: keep what was recorded so far
+            }
+
+            BookKey key;
+            key.key = board.getZobristKey(whiteToMove);
+            key.move = OpeningBook::encodeMove(board, move.first.first, move.first.second, move.second.first, move.second.second);
+            MoveCounts& entry = counts[key];
+            entry.games++;
+            if (result == "1/2-1/2") {
+                entry.draws++;
+            } else if (result == "1-0") {
+                whiteToMove ? entry.wins++ : entry.losses++;
+            } else if (result == "0-1") {
+                whiteToMove ? entry.losses++ : entry.wins++;
+            }
+            positions++;
+
+            board.movePiece(move.first.first, move.first.second, move.second.first, move.second.second);
+            whiteToMove = !whiteToMove;
+            ply++;
+
+            if (counts.size() >= options.runSize) {
+                spiller.spill(counts);
+            }
+        }
+        games++;
+    }
+};
+
+// Splits the mapped file into roughly equal chunks that start at "[Event "
+std::vector<std::pair<const char*, const char*>> splitChunks(const MappedFile& file, int count) {
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const char* end = data + file.size();
+    std::vector<std::pair<const char*, const char*>> chunks;
+
+    const char* start = data;
+    for (int i = 1; i <= count && start < end; ++i) {
+        const char* stop = end;
+        if (i < count) {
+            const char* guess = data + file.size() * i / count;
+            stop = guess < start ? start : guess;
+            const char* marker = "\n[Event ";
+            const char* found = std::search(stop, end, marker, marker + strlen(marker));
+            stop = (found == end) ? end : found + 1;
+        }
+        if (stop > start) {
+            chunks.push_back({start, stop});
+        }
+        start = stop;
+    }
+    return chunks;
+}
+
+bool readRecord(std::ifstream& file, RunRecord& record) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&record), sizeof(RunRecord)));
+}
+
+void writeKeyGroup(std::vector<RunRecord>& group, const Options& options, std::ofstream& out, size_t& written) {
+    // Polyglot convention: weight is 2 points per win and 1 per draw
+    std::vector<std::pair<const RunRecord*, uint64_t>> weighted;
+    uint64_t maxWeight = 0;
+    for (const auto& record : group) {
+        if (record.counts.games < options.minGames) continue;
+        uint64_t weight = 2ULL * record.counts.wins + record.counts.draws;
+        if (weight == 0) continue;
+        maxWeight = std::max(maxWeight, weight);
+        weighted.push_back({&record, weight});
+    }
+
+    // Weights are 16-bit: scale the group down if needed, keeping every move playable
+    std::vector<BookEntry> entries;
+    for (const auto& item : weighted) {
+        uint64_t weight = item.second;
+        if (maxWeight > 0xFFFF) {
+            weight = std::max<uint64_t>(1, weight * 0xFFFF / maxWeight);
+        }
+        BookEntry entry;
+        entry.key = item.first->key;
+        entry.move = item.first->move;
+        entry.weight = static_cast<uint16_t>(weight);
+        entry.learn = 0;
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) { return a.weight > b.weight; });
+
+    unsigned char bytes[16];
+    for (const auto& entry : entries) {
+        OpeningBook::writeEntry(entry, bytes);
+        out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+        written++;
+    }
+    group.clear();
+}
+
+// K-way merge of the sorted runs, summing counts of equal (key, move) records
+size_t mergeRuns(const std::vector<std::string>& paths, const Options& options) {
+    std::ofstream out(options.output, std::ios::binary);
+    if (!out.is_open()) {
+        std::cout << "Error: Could not open file " << options.output << " for writing.\n";
+        return 0;
+    }
+
+    std::vector<std::ifstream> runs;
+    for (const auto& path : paths) {
+        runs.emplace_back(path, std::ios::binary);
+    }
+
+    typedef std::pair<RunRecord, size_t> HeapItem;
+    auto greater = [](const HeapItem& a, const HeapItem& b) { return recordLess(b.first, a.first); };
+    std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(greater)> heap(greater);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        RunRecord record;
+        if (readRecord(runs[i], record)) heap.push({record, i});
+    }
+
+    std::vector<RunRecord> group;
+    size_t written = 0;
+    while (!heap.empty()) {
+        HeapItem item = heap.top();
+        heap.pop();
+        RunRecord next;
+        if (readRecord(runs[item.second], next)) heap.push({next, item.second});
+
+        if (!group.empty() && group.back().key != item.first.key) {
+            writeKeyGroup(group, options, out, written);
+        }
+        if (!group.empty() && group.back().move == item.first.move) {
+            MoveCounts& counts = group.back().counts;
+            counts.games += item.first.counts.games;
+            counts.wins += item.first.counts.wins;
+            counts.draws += item.first.counts.draws;
+            counts.losses += item.first.counts.losses;
+        } else {
+            group.push_back(item.first);
+        }
+    }
+    writeKeyGroup(group, options, out, written);
+    return written;
+}
+
+void printUsage() {
+    std::cout << "Usage: bookgen <games.pgn> <book.bin> [--plies N] [--threads N] [--min-games N] [--run-size N]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--plies") {
+            options.plies = std::stoi(argv[++i]);
+        } else if (i + 1 < argc && arg == "--threads") {
+            options.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--min-games") {
+            options.minGames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (i + 1 < argc && arg == "--run-size") {
+            options.runSize = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        printUsage();
+        return 1;
+    }
+    options.input = positional[0];
+    options.output = positional[1];
+
+    MappedFile file;
+    if (!file.open(options.input)) {
+        std::cout << "Error: Could not open file " << options.input << " for reading.\n";
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    RunSpiller spiller(options.output);
+    auto chunks = splitChunks(file, options.threads);
+
+    std::vector<GameReplayer> replayers;
+    replayers.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        replayers.emplace_back(options, spiller);
+    }
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        workers.emplace_back(&GameReplayer::parseChunk, &replayers[i], chunks[i].first, chunks[i].second);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    uint64_t games = 0;
+    uint64_t positions = 0;
+    for (const auto& replayer : replayers) {
+        games += replayer.getGames();
+        positions += replayer.getPositions();
+    }
+
+    size_t entries = mergeRuns(spiller.getPaths(), options);
+    for (const auto& path : spiller.getPaths()) {
+        std::remove(path.c_str());
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Games: " << games << " (" << static_cast<uint64_t>(games / std::max(seconds, 1e-9)) << " games/s)\n";
+    std::cout << "Positions: " << positions << "\n";
+    std::cout << "Runs merged: " << spiller.getPaths().size() << "\n";
+    std::cout << "Book entries: " << entries << " written to " << options.output << "\n";
+    std::cout << "Time: " << seconds << "s\n";
+    return 0;
+}
@@ -0,0 +1,296 @@
+// epdtest: runs the engine over an EPD test suite and reports the solve rate.
+//
+// Each EPD record gives a position (the first four FEN fields) and operations
+// such as bm (best moves), am (moves to avoid) and id. Records are read from
+// the file as the worker threads ask for them, each thread searching one
+// position at a time with its own Game under a time, node or depth budget.
+// A position counts as solved when the search ends on a bm move and on no am
+// move; its time to solution is when the search settled on such a move for
+// good, taken from the completed iterations.
+//
+// Usage: epdtest <suite.epd> [--movetime MS] [--nodes N] [--depth N] [--threads N] [--eval FILE|pst]
+
+#include "../include/Board.h"
+#include "../include/Game.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::pair<std::pair<int, int>, std::pair<int, int>> BoardMove;
+
+struct Options {
+    std::string input;
+    SearchLimits limits;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string network; // Empty keeps the default network, "pst" selects the piece-square tables
+};
+
+struct EpdRecord {
+    Board board;
+    bool whiteToMove = true;
+    std::string id;
+    std::vector<BoardMove> bestMoves;
+    std::vector<BoardMove> avoidMoves;
+    std::string bestText;
+    std::string avoidText;
+};
+
+// Operands of one operation, honouring quoted strings
+std::vector<std::string> splitOperands(const std::string& text) {
+    std::vector<std::string> operands;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && isspace(static_cast<unsigned char>(text[i]))) ++i;
+        if (i == text.size()) break;
+        if (text[i] == '"') {
+            size_t close = text.find('"', i + 1);
+            if (close == std::string::npos) close = text.size();
+            operands.push_back(text.substr(i + 1, close - i - 1));
+            i = close + 1;
+        } else {
+            size_t start = i;
+            while (i < text.size() && !isspace(static_cast<unsigned char>(text[i]))) ++i;
+            operands.push_back(text.substr(start, i - start));
+        }
+    }
+    return operands;
+}
+
+// "<placement> <side> <castling> <ep> {<opcode> {<operand>} ;}"
+bool parseEpd(const std::string& line, EpdRecord& record, std::string& error) {
+    std::istringstream fields(line);
+    std::string position[4];
+    for (auto& field : position) {
+        if (!(fields >> field)) {
+            error = "fewer than four position fields";
+            return false;
+        }
+    }
+    std::string operations;
+    std::getline(fields, operations);
+
+    // Split on semicolons outside quotes
+    std::string halfmove = "0";
+    std::string fullmove = "1";
+    std::vector<std::pair<std::string, std::vector<std::string>>> parsed;
+    std::string current;
+    bool quoted = false;
+    for (size_t i = 0; i <= operations.size(); ++i) {
+        char c = i < operations.size() ? operations[i] : ';';
+        if (c == '"') quoted = !quoted;
+        if (c != ';' || quoted) {
+            current += c;
+            continue;
+        }
+        std::vector<std::string> words = splitOperands(current);
+        current.clear();
+        if (words.empty()) continue;
+        std::string opcode = words[0];
+        words.erase(words.begin());
+        if (opcode == "hmvc" && !words.empty()) halfmove = words[0];
+        else if (opcode == "fmvn" && !words.empty()) fullmove = words[0];
+        else parsed.push_back({opcode, words});
+    }
+
+    int fullmoveNumber;
+    std::string fen = position[0] + " " + position[1] + " " + position[2] + " " + position[3] + " " + halfmove + " " + fullmove;
+    if (!record.board.loadFEN(fen, record.whiteToMove, fullmoveNumber)) {
+        error = "invalid position " + fen;
+        return false;
+    }
+
+    for (const auto& operation : parsed) {
+        if (operation.first == "id" && !operation.second.empty()) {
+            record.id = operation.second[0];
+        } else if (operation.first == "bm" || operation.first == "am") {
+            bool best = operation.first == "bm";
+            for (const auto& san : operation.second) {
+                BoardMove move = record.board.parseSAN(san, record.whiteToMove);
+                if (move.first.first == -1) {
+                    error = "unreadable " + operation.first + " move " + san;
+                    return false;
+                }
+                (best ? record.bestMoves : record.avoidMoves).push_back(move);
+                std::string& text = best ? record.bestText : record.avoidText;
+                text += (text.empty() ? "" : " ") + san;
+            }
+        }
+    }
+    if (record.bestMoves.empty() && record.avoidMoves.empty()) {
+        error = "no bm or am operation";
+        return false;
+    }
+    return true;
+}
+
+bool contains(const std::vector<BoardMove>& moves, const BoardMove& move) {
+    return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
+
+class SuiteRunner {
+public:
+    SuiteRunner(const Options& options, std::ifstream& input)
+        : options(options), input(input), lineNumber(0), positions(0), solved(0), solveSeconds(0.0), nodes(0) {}
+
+    void worker() {
+        Game engine;
+        if (!options.network.empty() && !engine.setNetwork(options.network == "pst" ? "" : options.network)) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "Error: Could not load network " << options.network << "; worker stopped\n";
+            return;
+        }
+
+        std::string line;
+        int number;
+        while (nextRecord(line, number)) {
+            EpdRecord record;
+            std::string error;
+            if (!parseEpd(line, record, error)) {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << "Line " << number << ": skipped, " << error << "\n";
+                continue;
+            }
+
+            // Time and nodes at which the search settled on an acceptable move
+            auto acceptable = [&record](const BoardMove& move) {
+                return (record.bestMoves.empty() || contains(record.bestMoves, move)) && !contains(record.avoidMoves, move);
+            };
+            double solvedAt = -1.0;
+            engine.clearSearchTables();
+            BoardMove move = engine.searchPosition(record.board, record.whiteToMove, options.limits,
+                [&](const SearchStats& stats, int, const std::vector<BoardMove>& pv) {
+                    if (pv.empty() || !acceptable(pv[0])) {
+                        solvedAt = -1.0;
+                    } else if (solvedAt < 0) {
+                        solvedAt = stats.seconds;
+                    }
+                });
+            SearchStats stats = engine.getLastSearchStats();
+            bool success = move.first.first != -1 && acceptable(move);
+            std::string played = move.first.first == -1 ? "none"
+                : record.board.toSAN(move.first.first, move.first.second, move.second.first, move.second.second);
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            positions++;
+            nodes += stats.nodes;
+            std::cout << std::fixed << std::setprecision(3);
+            std::cout << (record.id.empty() ? "line " + std::to_string(number) : record.id) << ": ";
+            if (success) {
+                solved++;
+                solveSeconds += std::max(solvedAt, 0.0);
+                std::cout << "solved with " << played << " in " << std::max(solvedAt, 0.0) << "s";
+            } else {
+                std::cout << "missed, played " << played;
+            }
+            if (!record.bestText.empty()) std::cout << " (bm " << record.bestText << ")";
+            if (!record.avoidText.empty()) std::cout << " (am " << record.avoidText << ")";
+            std::cout << ", depth " << stats.depth << ", " << stats.nodes << " nodes\n";
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+
+    int getPositions() const { return positions; }
+    int getSolved() const { return solved; }
+    double getSolveSeconds() const { return solveSeconds; }
+    uint64_t getNodes() const { return nodes; }
+
+private:
+    const Options& options;
+    std::ifstream& input;
+    std::mutex inputMutex;
+    std::mutex outputMutex;
+    int lineNumber;
+    int positions;
+    int solved;
+    double solveSeconds; // Summed over solved positions
+    uint64_t nodes;
+
+    // Records are read one at a time as threads become free, so the suite is never held in memory
+    bool nextRecord(std::string& line, int& number) {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        while (std::getline(input, line)) {
+            number = ++lineNumber;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos && line[start] != '#') {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+void printUsage() {
+    std::cout << "Usage: epdtest <suite.epd> [--movetime MS] [--nodes N] [--depth N] [--threads N] [--eval FILE|pst]\n"
+              << "Without a budget every position is searched for 1000 ms\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--movetime") {
+            options.limits.moveTime = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--nodes") {
+            options.limits.nodes = std::stoull(argv[++i]);
+        } else if (i + 1 < argc && arg == "--depth") {
+            options.limits.depth = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--threads") {
+            options.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--eval") {
+            options.network = argv[++i];
+        } else if (options.input.empty()) {
+            options.input = arg;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.input.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (options.limits.moveTime == 0 && options.limits.nodes == 0 && options.limits.depth == 0) {
+        options.limits.moveTime = 1000;
+    }
+
+    std::ifstream input(options.input);
+    if (!input.is_open()) {
+        std::cout << "Error: Could not open file " << options.input << " for reading.\n";
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    SuiteRunner runner(options, input);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.threads; ++i) {
+        workers.emplace_back(&SuiteRunner::worker, &runner);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    int positions = runner.getPositions();
+    int solved = runner.getSolved();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Solved: " << solved << "/" << positions << " (" << (positions ? 100.0 * solved / positions : 0.0) << "%)\n";
+    std::cout << std::setprecision(3);
+    if (solved > 0) {
+        std::cout << "Average time to solution: " << runner.getSolveSeconds() / solved << "s\n";
+    }
+    std::cout << "Time: " << seconds << "s, " << runner.getNodes() << " nodes ("
+              << static_cast<uint64_t>(runner.getNodes() / std::max(seconds, 1e-9)) << " nodes/s over all threads)\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+// fenbench: measures how fast Board::loadFEN sets up positions.
+//
+// Every FEN line of the input file is loaded --repeat times in turn, cycling
+// through the file so consecutive positions differ, as they do when a test
+// suite or training pipeline loads positions in bulk. Lines that do not load
+// are reported once and left out of the timing.
+//
+// Usage: fenbench <positions.fen> [--repeat N]
+
+#include "../include/Board.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::string input;
+    int repeat = 100;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--repeat") {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (input.empty()) {
+            input = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+    if (input.empty()) {
+        std::cout << "Usage: fenbench <positions.fen> [--repeat N]\n";
+        return 1;
+    }
+
+    std::ifstream file(input);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not open file " << input << " for reading.\n";
+        return 1;
+    }
+
+    Board board;
+    bool whiteToMove;
+    int fullmoveNumber;
+    std::vector<std::string> positions;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        if (!board.loadFEN(line, whiteToMove, fullmoveNumber)) {
+            std::cout << "Line " << lineNumber << ": invalid FEN " << line << "\n";
+            continue;
+        }
+        positions.push_back(line);
+    }
+    if (positions.empty()) {
+        std::cout << "Error: No valid positions in " << input << "\n";
+        return 1;
+    }
+
+    // The key sum keeps the loads from being optimised away
+    uint64_t checksum = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    for (int round = 0; round < repeat; ++round) {
+        for (const auto& fen : positions) {
+            board.loadFEN(fen, whiteToMove, fullmoveNumber);
+            checksum += board.getPieceKey();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    uint64_t loads = static_cast<uint64_t>(positions.size()) * repeat;
+    std::cout << "Positions: " << positions.size() << " x " << repeat << " = " << loads << " loads\n";
+    std::cout << "Time: " << seconds << "s (" << static_cast<uint64_t>(loads / std::max(seconds, 1e-9))
+              << " positions/s, " << 1e9 * seconds / loads << " ns each)\n";
+    std::cout << "Checksum: " << std::hex << checksum << std::dec << "\n";
+    return 0;
+}
@@ -0,0 +1,337 @@
+// match: plays two engine configurations against each other until a
+// sequential probability ratio test (SPRT) can tell which Elo hypothesis holds.
+//
+// Games are played in pairs: both games of a pair start from the same opening
+// and random plies with the colours swapped, and the pair is scored as a whole
+// (0, 0.5, 1, 1.5 or 2 points for engine1). The pentanomial counts of these
+// pair scores feed the log-likelihood ratio of H1 (engine1 is elo1 stronger)
+// against H0 (engine1 is elo0 stronger). Once the ratio leaves
+// [ln(beta / (1 - alpha)), ln((1 - beta) / alpha)] no further pairs are started.
+// Every worker thread owns one Game per engine, so neither engine sees the
+// other's search tables.
+//
+// Usage: match --engine1 SPEC --engine2 SPEC [--games N] [--threads N] [--openings FILE]
+//              [--random-plies N] [--max-plies N] [--elo0 E] [--elo1 E] [--alpha A] [--beta B]
+//              [--pgn FILE] [--seed N]
+// SPEC: <strength>[,eval=<file>|pst], as for selfplay
+
+#include "../include/Game.h"
+#include "../include/HeadlessGame.h"
+#include "../include/PgnWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    EngineConfig engines[2];
+    bool engineGiven[2] = {false, false};
+    int games = 20000; // Upper bound; the SPRT usually stops well before
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string openingsPath;
+    int randomPlies = 4;
+    int maxPlies = 400;
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+    std::string pgnPath;
+    unsigned seed = 1;
+};
+
+std::string today() {
+    std::time_t now = std::time(nullptr);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y.%m.%d", std::localtime(&now));
+    return buffer;
+}
+
+// Expected score of a player rated elo above its opponent
+double eloToScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double scoreToElo(double score) {
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+// Pair results as counts of 0, 0.5, 1, 1.5 and 2 points for engine1
+class Pentanomial {
+public:
+    Pentanomial() : counts{0, 0, 0, 0, 0} {}
+
+    void add(int halfPoints) { counts[halfPoints]++; }
+    int pairs() const { return counts[0] + counts[1] + counts[2] + counts[3] + counts[4]; }
+    int count(int halfPoints) const { return counts[halfPoints]; }
+
+    // Mean and variance of the per-game score of a pair. Each count is padded by
+    // a tiny amount so a clean sweep does not have zero variance
+    void moments(double& mean, double& variance) const {
+        const double epsilon = 1e-3;
+        double total = pairs() + 5 * epsilon;
+        mean = 0.0;
+        for (int i = 0; i < 5; ++i) {
+            mean += (counts[i] + epsilon) / total * (i / 4.0);
+        }
+        variance = 0.0;
+        for (int i = 0; i < 5; ++i) {
+            double deviation = i / 4.0 - mean;
+            variance += (counts[i] + epsilon) / total * deviation * deviation;
+        }
+    }
+
+    // Log-likelihood ratio of elo1 against elo0, in the normal approximation
+    double llr(double elo0, double elo1) const {
+        if (pairs() == 0) {
+            return 0.0;
+        }
+        double mean, variance;
+        moments(mean, variance);
+        double s0 = eloToScore(elo0);
+        double s1 = eloToScore(elo1);
+        return pairs() * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+    }
+
+    // Elo estimate with a 95% confidence margin
+    void elo(double& estimate, double& margin) const {
+        double mean, variance;
+        moments(mean, variance);
+        double error = 1.96 * std::sqrt(variance / std::max(pairs(), 1));
+        estimate = scoreToElo(mean);
+        margin = (scoreToElo(mean + error) - scoreToElo(mean - error)) / 2.0;
+    }
+
+private:
+    int counts[5];
+};
+
+class Match {
+public:
+    enum class Verdict { NONE, H0, H1 };
+
+    Match(const Options& options, const std::vector<std::string>& openings, PgnWriter* pgn)
+        : options(options), openings(openings), pgn(pgn), nextPair(0), decided(false), date(today()),
+          wins(0), draws(0), losses(0), verdict(Verdict::NONE),
+          lowerBound(std::log(options.beta / (1.0 - options.alpha))),
+          upperBound(std::log((1.0 - options.beta) / options.alpha)) {}
+
+    void worker() {
+        Game engines[2];
+        if (!options.engines[0].apply(engines[0]) || !options.engines[1].apply(engines[1])) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cout << "Error: Could not load a network; worker stopped\n";
+            return;
+        }
+
+        int maxPairs = (options.games + 1) / 2;
+        while (!decided) {
+            int pair = nextPair++;
+            if (pair >= maxPairs) {
+                break;
+            }
+
+            // Engine1 plays White in the first game and Black in the second
+            const std::string& opening = openings[pair % openings.size()];
+            unsigned seed = options.seed + static_cast<unsigned>(pair);
+            int halfPoints = 0;
+            int outcomes[3] = {0, 0, 0}; // Engine1 losses, draws and wins
+            PgnGame records[2];
+            std::string reasons[2];
+            for (int first = 0; first < 2; ++first) {
+                int white = first;
+                int black = 1 - first;
+                engines[0].clearSearchTables();
+                engines[1].clearSearchTables();
+                HeadlessGame game(opening, options.maxPlies);
+                game.play(engines[white], options.engines[white], engines[black], options.engines[black],
+                          options.randomPlies, seed);
+
+                const std::string& result = game.getResult();
+                int points = result == "1-0" ? 2 : result == "0-1" ? 0 : 1; // White's half points
+                points = white == 0 ? points : 2 - points;
+                halfPoints += points;
+                outcomes[points]++;
+                if (pgn) {
+                    records[first] = game.toRecord("Match", date, pair * 2 + first + 1,
+                                                   options.engines[white].name, options.engines[black].name);
+                    reasons[first] = game.getReason();
+                }
+            }
+            record(halfPoints, outcomes, records, reasons);
+        }
+    }
+
+    Verdict getVerdict() const { return verdict; }
+    const Pentanomial& getPentanomial() const { return pentanomial; }
+    int gamesPlayed() const { return wins + draws + losses; }
+
+    std::string summary() const {
+        double llr = pentanomial.llr(options.elo0, options.elo1);
+        double estimate, margin;
+        pentanomial.elo(estimate, margin);
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        out << "Games: " << gamesPlayed() << "  W: " << wins << " D: " << draws << " L: " << losses
+            << "  Elo: " << estimate << " +/- " << margin
+            << std::setprecision(2) << "  LLR: " << llr << " [" << lowerBound << ", " << upperBound << "]";
+        return out.str();
+    }
+
+private:
+    const Options& options;
+    const std::vector<std::string>& openings;
+    PgnWriter* pgn;
+    std::atomic<int> nextPair;
+    std::atomic<bool> decided;
+    std::string date;
+    std::mutex mutex;
+    Pentanomial pentanomial;
+    int wins, draws, losses; // Per game, from engine1's side
+    Verdict verdict;
+    double lowerBound, upperBound;
+
+    static const int MIN_PAIRS = 10;
+
+    void record(int halfPoints, const int outcomes[3], const PgnGame records[2], const std::string reasons[2]) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pgn) {
+            pgn->write(records[0], reasons[0]);
+            pgn->write(records[1], reasons[1]);
+        }
+        pentanomial.add(halfPoints);
+        losses += outcomes[0];
+        draws += outcomes[1];
+        wins += outcomes[2];
+
+        // Pairs still running when the test decides are counted but change nothing.
+        // The variance estimate means little over a handful of pairs, so wait for a few
+        if (verdict == Verdict::NONE && pentanomial.pairs() >= MIN_PAIRS) {
+            double llr = pentanomial.llr(options.elo0, options.elo1);
+            if (llr >= upperBound) verdict = Verdict::H1;
+            else if (llr <= lowerBound) verdict = Verdict::H0;
+            decided = verdict != Verdict::NONE;
+        }
+        if (pentanomial.pairs() % 10 == 0) {
+            std::cout << summary() << "\n";
+        }
+    }
+};
+
+void printUsage() {
+    std::cout << "Usage: match --engine1 SPEC --engine2 SPEC [--games N] [--threads N] [--openings FILE]\n"
+              << "             [--random-plies N] [--max-plies N] [--elo0 E] [--elo1 E] [--alpha A] [--beta B]\n"
+              << "             [--pgn FILE] [--seed N]\n"
+              << "SPEC: <strength>[,eval=<file>|pst], strength being random, greedy, minimax1..minimax3,\n"
+              << "      depthN, nodesN or movetimeN (milliseconds)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && (arg == "--engine1" || arg == "--engine2")) {
+            int engine = arg == "--engine1" ? 0 : 1;
+            if (!options.engines[engine].parse(argv[++i])) {
+                std::cout << "Error: Unknown engine " << argv[i] << "\n";
+                printUsage();
+                return 1;
+            }
+            options.engineGiven[engine] = true;
+        } else if (i + 1 < argc && arg == "--games") {
+            options.games = std::max(2, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--threads") {
+            options.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--openings") {
+            options.openingsPath = argv[++i];
+        } else if (i + 1 < argc && arg == "--random-plies") {
+            options.randomPlies = std::max(0, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--max-plies") {
+            options.maxPlies = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--elo0") {
+            options.elo0 = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--elo1") {
+            options.elo1 = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--alpha") {
+            options.alpha = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--beta") {
+            options.beta = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--pgn") {
+            options.pgnPath = argv[++i];
+        } else if (i + 1 < argc && arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!options.engineGiven[0] || !options.engineGiven[1]) {
+        printUsage();
+        return 1;
+    }
+    if (options.elo1 <= options.elo0 || options.alpha <= 0.0 || options.alpha >= 1.0 ||
+        options.beta <= 0.0 || options.beta >= 1.0) {
+        std::cout << "Error: SPRT needs elo0 < elo1 and alpha, beta between 0 and 1\n";
+        return 1;
+    }
+
+    std::vector<std::string> openings;
+    if (!HeadlessGame::readOpenings(options.openingsPath, openings)) {
+        std::cout << "Error: Could not open file " << options.openingsPath << " for reading.\n";
+        return 1;
+    }
+
+    PgnWriter pgn;
+    if (!options.pgnPath.empty()) {
+        if (!pgn.open(options.pgnPath)) {
+            std::cout << "Error: Could not open file " << options.pgnPath << " for writing.\n";
+            return 1;
+        }
+    }
+
+    std::cout << options.engines[0].name << " vs " << options.engines[1].name << ", SPRT elo0 = " << options.elo0
+              << " elo1 = " << options.elo1 << " alpha = " << options.alpha << " beta = " << options.beta << "\n";
+    auto startTime = std::chrono::steady_clock::now();
+    Match match(options, openings, pgn.isOpen() ? &pgn : nullptr);
+    int maxPairs = (options.games + 1) / 2;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::min(options.threads, maxPairs); ++i) {
+        workers.emplace_back(&Match::worker, &match);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    const Pentanomial& pentanomial = match.getPentanomial();
+    std::cout << match.summary() << "\n";
+    std::cout << "Pairs (0, 0.5, 1, 1.5, 2 points): " << pentanomial.count(0) << " " << pentanomial.count(1) << " "
+              << pentanomial.count(2) << " " << pentanomial.count(3) << " " << pentanomial.count(4) << "\n";
+    std::cout << "Time: " << seconds << "s (" << match.gamesPlayed() / std::max(seconds, 1e-9) << " games/s)\n";
+    switch (match.getVerdict()) {
+        case Match::Verdict::H1:
+            std::cout << "H1 accepted: " << options.engines[0].name << " is at least " << options.elo1
+                      << " Elo stronger\n";
+            break;
+        case Match::Verdict::H0:
+            std::cout << "H0 accepted: " << options.engines[0].name << " is not " << options.elo1
+                      << " Elo stronger\n";
+            break;
+        case Match::Verdict::NONE:
+            std::cout << "Inconclusive: the game limit was reached before the SPRT decided\n";
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+// pgnscan: reads every game of a PGN database, replaying its SAN moves, and
+// reports how many games could be read and how fast.
+//
+// The file is memory-mapped and read one game at a time by PgnReader, so the
+// memory used does not grow with the size of the database. Games whose
+// movetext cannot be replayed are counted and the first few are listed.
+//
+// Usage: pgnscan <games.pgn> [--errors N]
+
+#include "../include/PgnReader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    std::string input;
+    uint64_t maxErrors = 10;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--errors") {
+            maxErrors = std::stoull(argv[++i]);
+        } else if (input.empty()) {
+            input = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+    if (input.empty()) {
+        std::cout << "Usage: pgnscan <games.pgn> [--errors N]\n";
+        return 1;
+    }
+
+    PgnReader reader;
+    if (!reader.open(input)) {
+        std::cout << "Error: Could not open file " << input << " for reading.\n";
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    PgnGame game;
+    uint64_t games = 0;
+    uint64_t errors = 0;
+    uint64_t plies = 0;
+    std::map<std::string, uint64_t> results;
+    while (reader.next(game)) {
+        games++;
+        plies += game.moves.size();
+        results[game.result]++;
+        if (!game.isValid()) {
+            if (errors < maxErrors) {
+                std::cout << "Game " << games << ": " << game.error << "\n";
+            }
+            errors++;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    double megabytes = reader.getBytesRead() / (1024.0 * 1024.0);
+    std::cout << "Games: " << games << " (" << errors << " with unreadable movetext)\n";
+    std::cout << "Plies: " << plies << "\n";
+    std::cout << "Results:";
+    for (const auto& result : results) {
+        std::cout << " " << result.first << " " << result.second;
+    }
+    std::cout << "\n";
+    std::cout << "Time: " << seconds << "s (" << static_cast<uint64_t>(games / std::max(seconds, 1e-9)) << " games/s, "
+              << megabytes / std::max(seconds, 1e-9) << " MB/s)\n";
+    return 0;
+}
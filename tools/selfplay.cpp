@@ -0,0 +1,197 @@
+// selfplay: plays AI-vs-AI games on a pool of threads and writes them as PGN.
+//
+// Two players are configured by strength and evaluator. Each opening is
+// played twice with the colours swapped, so neither player profits from a
+// lopsided opening.
+// Openings come from a file of FEN lines (the start position if none is
+// given), followed by a few random plies so repeated openings still diverge.
+// Every worker thread owns its own Game and therefore its own search tables.
+// Games are played by HeadlessGame and adjudicated drawn after --max-plies.
+//
+// Usage: selfplay <output.pgn> [--games N] [--threads N] [--first SPEC] [--second SPEC]
+//                 [--openings FILE] [--random-plies N] [--max-plies N] [--seed N]
+// SPEC: <strength>[,eval=<file>|pst], strength being random, greedy, minimax1..minimax3,
+//       depthN, nodesN or movetimeN (milliseconds)
+
+#include "../include/Board.h"
+#include "../include/Game.h"
+#include "../include/HeadlessGame.h"
+#include "../include/PgnWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string output;
+    int games = 100;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    EngineConfig players[2];
+    std::string openingsPath;
+    int randomPlies = 4;
+    int maxPlies = 400;
+    unsigned seed = 1;
+};
+
+std::string today() {
+    std::time_t now = std::time(nullptr);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y.%m.%d", std::localtime(&now));
+    return buffer;
+}
+
+class SelfPlay {
+public:
+    SelfPlay(const Options& options, const std::vector<std::string>& openings, PgnWriter& output)
+        : options(options), openings(openings), output(output), nextGame(0), date(today()),
+          wins(0), draws(0), losses(0), totalPlies(0) {}
+
+    void worker() {
+        // Both players share one engine unless they evaluate differently
+        Game first;
+        std::unique_ptr<Game> second;
+        if (options.players[0].network != options.players[1].network) {
+            second.reset(new Game());
+        }
+        Game* engines[2] = {&first, second ? second.get() : &first};
+        if (!options.players[0].apply(*engines[0]) || !options.players[1].apply(*engines[1])) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cout << "Error: Could not load a network; worker stopped\n";
+            return;
+        }
+        
+        while (true) {
+            int index = nextGame++;
+            if (index >= options.games) {
+                break;
+            }
+            first.clearSearchTables();
+            if (second) second->clearSearchTables();
+            
+            // Games 2k and 2k+1 share an opening with the colours swapped
+            int pair = index / 2;
+            int white = index % 2;
+            int black = 1 - white;
+            HeadlessGame game(openings[pair % openings.size()], options.maxPlies);
+            game.play(*engines[white], options.players[white], *engines[black], options.players[black],
+                      options.randomPlies, options.seed + static_cast<unsigned>(pair));
+            PgnGame record = game.toRecord("Self-play", date, index + 1, options.players[white].name, options.players[black].name);
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            output.write(record, game.getReason());
+            if (game.getResult() == "1/2-1/2") draws++;
+            else if ((game.getResult() == "1-0") == (white == 0)) wins++;
+            else losses++;
+            totalPlies += game.getMoves().size();
+            int finished = wins + draws + losses;
+            if (finished % 100 == 0 || finished == options.games) {
+                std::cout << "Finished " << finished << "/" << options.games << " games\n";
+            }
+        }
+    }
+
+    int getWins() const { return wins; }
+    int getDraws() const { return draws; }
+    int getLosses() const { return losses; }
+    uint64_t getPlies() const { return totalPlies; }
+
+private:
+    const Options& options;
+    const std::vector<std::string>& openings;
+    PgnWriter& output;
+    std::atomic<int> nextGame;
+    std::string date;
+    std::mutex mutex;
+    int wins, draws, losses; // From the first player's side
+    uint64_t totalPlies;
+};
+
+void printUsage() {
+    std::cout << "Usage: selfplay <output.pgn> [--games N] [--threads N] [--first SPEC] [--second SPEC]\n"
+              << "                [--openings FILE] [--random-plies N] [--max-plies N] [--seed N]\n"
+              << "SPEC: <strength>[,eval=<file>|pst], strength being random, greedy, minimax1..minimax3,\n"
+              << "      depthN, nodesN or movetimeN (milliseconds)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.players[0].parse("depth3");
+    options.players[1].parse("depth2");
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--games") {
+            options.games = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--threads") {
+            options.threads = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && (arg == "--first" || arg == "--second")) {
+            if (!options.players[arg == "--first" ? 0 : 1].parse(argv[++i])) {
+                std::cout << "Error: Unknown player " << argv[i] << "\n";
+                printUsage();
+                return 1;
+            }
+        } else if (i + 1 < argc && arg == "--openings") {
+            options.openingsPath = argv[++i];
+        } else if (i + 1 < argc && arg == "--random-plies") {
+            options.randomPlies = std::max(0, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--max-plies") {
+            options.maxPlies = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 1) {
+        printUsage();
+        return 1;
+    }
+    options.output = positional[0];
+
+    std::vector<std::string> openings;
+    if (!HeadlessGame::readOpenings(options.openingsPath, openings)) {
+        std::cout << "Error: Could not open file " << options.openingsPath << " for reading.\n";
+        return 1;
+    }
+
+    PgnWriter output;
+    if (!output.open(options.output)) {
+        std::cout << "Error: Could not open file " << options.output << " for writing.\n";
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    SelfPlay selfPlay(options, openings, output);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::min(options.threads, options.games); ++i) {
+        workers.emplace_back(&SelfPlay::worker, &selfPlay);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    int games = selfPlay.getWins() + selfPlay.getDraws() + selfPlay.getLosses();
+    double score = (selfPlay.getWins() + 0.5 * selfPlay.getDraws()) / std::max(games, 1);
+    std::cout << options.players[0].name << " vs " << options.players[1].name << ": +" << selfPlay.getWins()
+              << " =" << selfPlay.getDraws() << " -" << selfPlay.getLosses() << " (" << static_cast<int>(score * 1000) / 10.0
+              << "%)\n";
+    std::cout << "Games: " << games << " in " << seconds << "s (" << games / std::max(seconds, 1e-9) << " games/s, "
+              << static_cast<uint64_t>(selfPlay.getPlies() / std::max(seconds, 1e-9)) << " plies/s)\n";
+    if (!output.flush()) {
+        std::cout << "Error: Could not write " << options.output << "\n";
+        return 1;
+    }
+    std::cout << "PGN written to " << options.output << "\n";
+    return 0;
+}
@@ -0,0 +1,587 @@
+// tbgen: generates win/draw/loss and distance-to-mate endgame tables.
+//
+// Tables are built by retrograde analysis over the whole indexed position
+// space of one material signature (see EndgameTablebase.h for the layout):
+//   1. Every legal position counts its moves. Captures and promotions lead to
+//      smaller tables (generated first) and are scored straight away; mates
+//      and stalemates are decided.
+//   2. Level by level (distance to mate in plies), positions decided at that
+//      level are un-moved to their predecessors: a predecessor of a loss is a
+//      win one ply longer, and a predecessor loses once all its moves lead to
+//      wins for the opponent.
+//   3. Whatever is left undecided is a draw.
+// Both the counting pass and each level are split across threads.
+//
+// Usage: tbgen <output-dir> [signature ...] [--threads N]
+//        e.g. tbgen tablebases KQvK KRvK KPvK KBNvK
+
+#include "../include/EndgameTablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int MAX_PIECES = EndgameTablebase::MAX_PIECES;
+const uint8_t UNDECIDED = 4; // Working value next to the TablebaseWDL values
+const uint8_t NO_DTM = 255;
+
+struct TableData {
+    std::string pieces;   // Index order, e.g. "KQk"
+    uint64_t size;
+    std::vector<uint8_t> value;
+    std::vector<uint8_t> dtm;
+};
+
+std::map<std::string, TableData> tables;
+int threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+struct Position {
+    int count;
+    char symbol[MAX_PIECES];
+    int square[MAX_PIECES]; // x * 8 + y, x = 0 is the eighth rank
+    bool whiteToMove;
+};
+
+bool isWhitePiece(char symbol) { return symbol >= 'A' && symbol <= 'Z'; }
+
+int pieceValue(char symbol) {
+    switch (toupper(symbol)) {
+        case 'Q': return 9;
+        case 'R': return 5;
+        case 'B': case 'N': return 3;
+        case 'P': return 1;
+        default: return 0;
+    }
+}
+
+// Chooses the colour orientation we generate: stronger side as White
+std::string canonicalSignature(const std::string& signature) {
+    size_t split = signature.find('v');
+    std::string white = signature.substr(0, split);
+    std::string black = signature.substr(split + 1);
+    int whiteValue = 0;
+    int blackValue = 0;
+    for (char c : white) whiteValue += pieceValue(c);
+    for (char c : black) blackValue += pieceValue(c);
+    if (blackValue > whiteValue || (blackValue == whiteValue && black.length() > white.length())) {
+        return black + "v" + white;
+    }
+    return signature;
+}
+
+std::string signatureOf(const Position& pos) {
+    std::string sides[2];
+    const char* order = "KQRBNP";
+    for (int side = 0; side < 2; ++side) {
+        for (const char* type = order; *type; ++type) {
+            for (int i = 0; i < pos.count; ++i) {
+                if (toupper(pos.symbol[i]) == *type && isWhitePiece(pos.symbol[i]) == (side == 0)) {
+                    sides[side] += *type;
+                }
+            }
+        }
+    }
+    return sides[0] + "v" + sides[1];
+}
+
+void decode(const TableData& table, uint64_t index, Position& pos) {
+    pos.count = static_cast<int>(table.pieces.length());
+    pos.whiteToMove = (index & 1) == 0;
+    uint64_t squares = index >> 1;
+    for (int i = 0; i < pos.count; ++i) {
+        pos.symbol[i] = table.pieces[i];
+        pos.square[i] = static_cast<int>(squares & 63);
+        squares >>= 6;
+    }
+}
+
+uint64_t encode(const Position& pos) {
+    uint64_t squares = 0;
+    for (int i = pos.count - 1; i >= 0; --i) {
+        squares = squares * 64 + pos.square[i];
+    }
+    return (pos.whiteToMove ? 0 : 1) + 2 * squares;
+}
+
+void fillOccupancy(const Position& pos, int occupancy[64]) {
+    std::fill(occupancy, occupancy + 64, -1);
+    for (int i = 0; i < pos.count; ++i) {
+        occupancy[pos.square[i]] = i;
+    }
+}
+
+bool onBoard(int x, int y) { return x >= 0 && x < 8 && y >= 0 && y < 8; }
+
+const int KNIGHT_STEPS[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+const int KING_STEPS[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+
+bool attacks(char symbol, int from, int to, const int occupancy[64]) {
+    int x1 = from / 8, y1 = from % 8, x2 = to / 8, y2 = to % 8;
+    int dx = x2 - x1, dy = y2 - y1;
+    switch (toupper(symbol)) {
+        case 'K': return from != to && abs(dx) <= 1 && abs(dy) <= 1;
+        case 'N': return (abs(dx) == 2 && abs(dy) == 1) || (abs(dx) == 1 && abs(dy) == 2);
+        case 'P': return dx == (isWhitePiece(symbol) ? -1 : 1) && abs(dy) == 1;
+        default: break;
+    }
+
+    bool straight = (dx == 0) != (dy == 0);
+    bool diagonal = dx != 0 && abs(dx) == abs(dy);
+    char type = static_cast<char>(toupper(symbol));
+    if (!((straight && (type == 'R' || type == 'Q')) || (diagonal && (type == 'B' || type == 'Q')))) {
+        return false;
+    }
+    int stepX = (dx > 0) - (dx < 0);
+    int stepY = (dy > 0) - (dy < 0);
+    for (int x = x1 + stepX, y = y1 + stepY; x != x2 || y != y2; x += stepX, y += stepY) {
+        if (occupancy[x * 8 + y] != -1) return false;
+    }
+    return true;
+}
+
+bool kingAttacked(const Position& pos, const int occupancy[64], bool whiteKing) {
+    int king = -1;
+    for (int i = 0; i < pos.count; ++i) {
+        if (pos.symbol[i] == (whiteKing ? 'K' : 'k')) king = pos.square[i];
+    }
+    for (int i = 0; i < pos.count; ++i) {
+        if (pos.square[i] >= 0 && isWhitePiece(pos.symbol[i]) != whiteKing &&
+            attacks(pos.symbol[i], pos.square[i], king, occupancy)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Index positions that can never arise are left as TB_UNKNOWN
+bool isLegal(const Position& pos, const int occupancy[64]) {
+    for (int i = 0; i < pos.count; ++i) {
+        if (occupancy[pos.square[i]] != i) return false; // Two pieces on a square
+        if (toupper(pos.symbol[i]) == 'P' && (pos.square[i] / 8 == 0 || pos.square[i] / 8 == 7)) return false;
+    }
+    return !kingAttacked(pos, occupancy, !pos.whiteToMove);
+}
+
+// Calls visit(piece, target) for every pseudo-legal destination of the side to move
+void forEachMove(const Position& pos, const int occupancy[64], const std::function<void(int, int)>& visit) {
+    for (int i = 0; i < pos.count; ++i) {
+        char symbol = pos.symbol[i];
+        if (isWhitePiece(symbol) != pos.whiteToMove) continue;
+        int x = pos.square[i] / 8, y = pos.square[i] % 8;
+        auto canLand = [&](int tx, int ty) {
+            int occupant = occupancy[tx * 8 + ty];
+            return occupant == -1 || isWhitePiece(pos.symbol[occupant]) != pos.whiteToMove;
+        };
+
+        char type = static_cast<char>(toupper(symbol));
+        if (type == 'K' || type == 'N') {
+            const int (*steps)[2] = (type == 'K') ? KING_STEPS : KNIGHT_STEPS;
+            for (int s = 0; s < 8; ++s) {
+                int tx = x + steps[s][0], ty = y + steps[s][1];
+                if (onBoard(tx, ty) && canLand(tx, ty)) visit(i, tx * 8 + ty);
+            }
+        } else if (type == 'P') {
+            int dir = isWhitePiece(symbol) ? -1 : 1;
+            int startRow = isWhitePiece(symbol) ? 6 : 1;
+            if (onBoard(x + dir, y) && occupancy[(x + dir) * 8 + y] == -1) {
+                visit(i, (x + dir) * 8 + y);
+                if (x == startRow && occupancy[(x + 2 * dir) * 8 + y] == -1) visit(i, (x + 2 * dir) * 8 + y);
+            }
+            for (int dy = -1; dy <= 1; dy += 2) {
+                int tx = x + dir, ty = y + dy;
+                if (onBoard(tx, ty) && occupancy[tx * 8 + ty] != -1 && canLand(tx, ty)) visit(i, tx * 8 + ty);
+            }
+        } else {
+            for (int s = 0; s < 8; ++s) {
+                bool diagonal = KING_STEPS[s][0] != 0 && KING_STEPS[s][1] != 0;
+                if ((diagonal && type == 'R') || (!diagonal && type == 'B')) continue;
+                for (int tx = x + KING_STEPS[s][0], ty = y + KING_STEPS[s][1]; onBoard(tx, ty);
+                     tx += KING_STEPS[s][0], ty += KING_STEPS[s][1]) {
+                    if (!canLand(tx, ty)) break;
+                    visit(i, tx * 8 + ty);
+                    if (occupancy[tx * 8 + ty] != -1) break;
+                }
+            }
+        }
+    }
+}
+
+// Calls visit(piece, origin) for every quiet move of the side NOT to move that could have led here
+void forEachUnmove(const Position& pos, const int occupancy[64], const std::function<void(int, int)>& visit) {
+    for (int i = 0; i < pos.count; ++i) {
+        char symbol = pos.symbol[i];
+        if (isWhitePiece(symbol) == pos.whiteToMove) continue;
+        int x = pos.square[i] / 8, y = pos.square[i] % 8;
+
+        char type = static_cast<char>(toupper(symbol));
+        if (type == 'K' || type == 'N') {
+            const int (*steps)[2] = (type == 'K') ? KING_STEPS : KNIGHT_STEPS;
+            for (int s = 0; s < 8; ++s) {
+                int fx = x + steps[s][0], fy = y + steps[s][1];
+                if (onBoard(fx, fy) && occupancy[fx * 8 + fy] == -1) visit(i, fx * 8 + fy);
+            }
+        } else if (type == 'P') {
+            int dir = isWhitePiece(symbol) ? -1 : 1;
+            int startRow = isWhitePiece(symbol) ? 6 : 1;
+            int fx = x - dir;
+            if (fx != 0 && fx != 7 && occupancy[fx * 8 + y] == -1) {
+                visit(i, fx * 8 + y);
+                if (fx - dir == startRow && occupancy[(fx - dir) * 8 + y] == -1) visit(i, (fx - dir) * 8 + y);
+            }
+        } else {
+            for (int s = 0; s < 8; ++s) {
+                bool diagonal = KING_STEPS[s][0] != 0 && KING_STEPS[s][1] != 0;
+                if ((diagonal && type == 'R') || (!diagonal && type == 'B')) continue;
+                for (int fx = x + KING_STEPS[s][0], fy = y + KING_STEPS[s][1]; onBoard(fx, fy);
+                     fx += KING_STEPS[s][0], fy += KING_STEPS[s][1]) {
+                    if (occupancy[fx * 8 + fy] != -1) break;
+                    visit(i, fx * 8 + fy);
+                }
+            }
+        }
+    }
+}
+
+// Value of a position in an already generated (smaller) table
+void lookup(const Position& pos, int& value, int& dtm) {
+    std::string signature = signatureOf(pos);
+    value = TB_DRAW;
+    dtm = NO_DTM;
+    if (signature == "KvK") return;
+
+    bool swapColors = false;
+    auto it = tables.find(signature);
+    if (it == tables.end()) {
+        swapColors = true;
+        size_t split = signature.find('v');
+        it = tables.find(signature.substr(split + 1) + "v" + signature.substr(0, split));
+    }
+    const TableData& table = it->second;
+
+    Position mapped;
+    mapped.count = pos.count;
+    mapped.whiteToMove = swapColors ? !pos.whiteToMove : pos.whiteToMove;
+    bool used[MAX_PIECES] = {false};
+    for (int slot = 0; slot < mapped.count; ++slot) {
+        mapped.symbol[slot] = table.pieces[slot];
+        for (int i = 0; i < pos.count; ++i) {
+            char symbol = pos.symbol[i];
+            int square = pos.square[i];
+            if (swapColors) {
+                symbol = isWhitePiece(symbol) ? static_cast<char>(tolower(symbol)) : static_cast<char>(toupper(symbol));
+                square = (7 - square / 8) * 8 + square % 8;
+            }
+            if (!used[i] && symbol == table.pieces[slot]) {
+                used[i] = true;
+                mapped.square[slot] = square;
+                break;
+            }
+        }
+    }
+
+    uint64_t index = encode(mapped);
+    value = table.value[index];
+    dtm = table.dtm[index];
+}
+
+void parallelFor(uint64_t size, const std::function<void(uint64_t, uint64_t, int)>& work) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        uint64_t begin = size * t / threadCount;
+        uint64_t end = size * (t + 1) / threadCount;
+        workers.emplace_back(work, begin, end, t);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void atomicMin(std::atomic<uint8_t>& target, uint8_t value) {
+    uint8_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void atomicMax(std::atomic<uint8_t>& target, uint8_t value) {
+    uint8_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+uint8_t plusOne(int dtm) {
+    return static_cast<uint8_t>(std::min(dtm + 1, NO_DTM - 1));
+}
+
+void generate(const std::string& signature) {
+    if (tables.count(signature) || signature == "KvK") return;
+
+    // Smaller tables reached by captures and promotions come first
+    std::string pieces = EndgameTablebase::getTablePieces(signature);
+    for (size_t i = 0; i < pieces.length(); ++i) {
+        if (toupper(pieces[i]) == 'K') continue;
+        std::string smaller = pieces.substr(0, i) + pieces.substr(i + 1);
+        Position shape;
+        shape.count = static_cast<int>(smaller.length());
+        std::copy(smaller.begin(), smaller.end(), shape.symbol);
+        generate(canonicalSignature(signatureOf(shape)));
+
+        if (toupper(pieces[i]) == 'P') {
+            for (size_t j = 0; j <= smaller.length(); ++j) {
+                // Promotion, with or without capturing piece j
+                std::string promoted = pieces;
+                promoted[i] = isWhitePiece(pieces[i]) ? 'Q' : 'q';
+                if (j < smaller.length()) {
+                    size_t captured = (j < i) ? j : j + 1;
+                    if (toupper(promoted[captured]) == 'K' || isWhitePiece(promoted[captured]) == isWhitePiece(pieces[i])) continue;
+                    promoted.erase(captured, 1);
+                }
+                shape.count = static_cast<int>(promoted.length());
+                std::copy(promoted.begin(), promoted.end(), shape.symbol);
+                generate(canonicalSignature(signatureOf(shape)));
+            }
+        }
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    TableData& table = tables[signature];
+    table.pieces = pieces;
+    table.size = EndgameTablebase::getTableSize(static_cast<int>(pieces.length()));
+    table.value.assign(table.size, TB_UNKNOWN);
+    table.dtm.assign(table.size, NO_DTM);
+
+    std::unique_ptr<std::atomic<uint8_t>[]> remaining(new std::atomic<uint8_t>[table.size]);
+    std::unique_ptr<std::atomic<uint8_t>[]> winDtm(new std::atomic<uint8_t>[table.size]);
+    std::unique_ptr<std::atomic<uint8_t>[]> lossDtm(new std::atomic<uint8_t>[table.size]);
+    size_t workingBytes = table.size * (2 + 3 * sizeof(std::atomic<uint8_t>));
+
+    // Pass 1: count moves, score conversions, find mates and stalemates
+    parallelFor(table.size, [&](uint64_t begin, uint64_t end, int) {
+        Position pos;
+        int occupancy[64];
+        for (uint64_t index = begin; index < end; ++index) {
+            remaining[index].store(0, std::memory_order_relaxed);
+            winDtm[index].store(NO_DTM, std::memory_order_relaxed);
+            lossDtm[index].store(0, std::memory_order_relaxed);
+
+            decode(table, index, pos);
+            fillOccupancy(pos, occupancy);
+            if (!isLegal(pos, occupancy)) continue;
+
+            int moves = 0;
+            int count = 0;
+            uint8_t bestWin = NO_DTM;
+            uint8_t longestLoss = 0;
+            forEachMove(pos, occupancy, [&](int piece, int target) {
+                Position child = pos;
+                child.whiteToMove = !pos.whiteToMove;
+                int captured = occupancy[target];
+                child.square[piece] = target;
+                bool promotes = toupper(pos.symbol[piece]) == 'P' && (target / 8 == 0 || target / 8 == 7);
+                if (promotes) child.symbol[piece] = isWhitePiece(pos.symbol[piece]) ? 'Q' : 'q';
+                if (captured != -1) {
+                    for (int k = captured; k + 1 < child.count; ++k) {
+                        child.symbol[k] = child.symbol[k + 1];
+                        child.square[k] = child.square[k + 1];
+                    }
+                    child.count--;
+                }
+
+                int childOccupancy[64];
+                fillOccupancy(child, childOccupancy);
+                if (kingAttacked(child, childOccupancy, pos.whiteToMove)) return;
+                moves++;
+
+                if (captured == -1 && !promotes) {
+                    count++; // Resolved later by the retrograde passes
+                    return;
+                }
+                int value, dtm;
+                lookup(child, value, dtm);
+                if (value == TB_LOSS) {
+                    bestWin = std::min(bestWin, plusOne(dtm));
+                    count++;
+                } else if (value == TB_WIN) {
+                    longestLoss = std::max(longestLoss, plusOne(dtm));
+                } else {
+                    count++; // A drawing conversion can never be refuted
+                }
+            });
+
+            if (moves == 0) {
+                table.value[index] = kingAttacked(pos, occupancy, pos.whiteToMove) ? TB_LOSS : TB_DRAW;
+                table.dtm[index] = (table.value[index] == TB_LOSS) ? 0 : NO_DTM;
+                continue;
+            }
+            table.value[index] = UNDECIDED;
+            remaining[index].store(static_cast<uint8_t>(count), std::memory_order_relaxed);
+            winDtm[index].store(bestWin, std::memory_order_relaxed);
+            lossDtm[index].store(longestLoss, std::memory_order_relaxed);
+        }
+    });
+
+    // Pass 2: retrograde levels
+    std::vector<std::vector<uint64_t>> decided(threadCount);
+    parallelFor(table.size, [&](uint64_t begin, uint64_t end, int thread) {
+        for (uint64_t index = begin; index < end; ++index) {
+            if (table.value[index] == TB_LOSS) decided[thread].push_back(index);
+        }
+    });
+
+    int maxDtm = 0;
+    for (int level = 0; level < NO_DTM - 1; ++level) {
+        // Propagate the positions decided at this level to their predecessors
+        parallelFor(threadCount, [&](uint64_t first, uint64_t last, int) {
+            Position pos;
+            int occupancy[64];
+            for (uint64_t t = first; t < last; ++t) {
+                for (uint64_t index : decided[t]) {
+                    decode(table, index, pos);
+                    fillOccupancy(pos, occupancy);
+                    bool childLoses = table.value[index] == TB_LOSS;
+                    forEachUnmove(pos, occupancy, [&](int piece, int origin) {
+                        Position parent = pos;
+                        parent.square[piece] = origin;
+                        parent.whiteToMove = !pos.whiteToMove;
+                        uint64_t parentIndex = encode(parent);
+                        if (table.value[parentIndex] != UNDECIDED) return;
+                        if (childLoses) {
+                            atomicMin(winDtm[parentIndex], static_cast<uint8_t>(level + 1));
+                        } else {
+                            atomicMax(lossDtm[parentIndex], static_cast<uint8_t>(level + 1));
+                            remaining[parentIndex].fetch_sub(1, std::memory_order_relaxed);
+                        }
+                    });
+                }
+            }
+        });
+
+        // Collect the positions whose result is now known at the next level
+        bool pending = false;
+        std::vector<char> anyPending(threadCount, 0);
+        parallelFor(table.size, [&](uint64_t begin, uint64_t end, int thread) {
+            decided[thread].clear();
+            for (uint64_t index = begin; index < end; ++index) {
+                if (table.value[index] != UNDECIDED) continue;
+                uint8_t win = winDtm[index].load(std::memory_order_relaxed);
+                uint8_t loss = lossDtm[index].load(std::memory_order_relaxed);
+                bool lost = remaining[index].load(std::memory_order_relaxed) == 0;
+                if (win == level + 1) {
+                    table.value[index] = TB_WIN;
+                    table.dtm[index] = win;
+                    decided[thread].push_back(index);
+                } else if (win == NO_DTM && lost && loss == level + 1) {
+                    table.value[index] = TB_LOSS;
+                    table.dtm[index] = loss;
+                    decided[thread].push_back(index);
+                } else if (win != NO_DTM || lost) {
+                    anyPending[thread] = 1; // Decided at a later level
+                }
+            }
+        });
+
+        bool progress = false;
+        for (int t = 0; t < threadCount; ++t) {
+            progress = progress || !decided[t].empty();
+            pending = pending || anyPending[t];
+        }
+        if (progress) maxDtm = level + 1;
+        if (!progress && !pending) break;
+    }
+
+    // Pass 3: everything still undecided can be held forever
+    uint64_t counts[4] = {0, 0, 0, 0};
+    for (uint64_t index = 0; index < table.size; ++index) {
+        if (table.value[index] == UNDECIDED) table.value[index] = TB_DRAW;
+        counts[table.value[index]]++;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << signature << ": " << (table.size - counts[TB_UNKNOWN]) << " legal positions, "
+              << counts[TB_WIN] << " wins, " << counts[TB_DRAW] << " draws, " << counts[TB_LOSS] << " losses, "
+              << "longest mate " << maxDtm << " plies, " << seconds << "s, "
+              << (workingBytes / (1024 * 1024)) << " MB working memory\n";
+}
+
+bool writeTable(const std::string& directory, const std::string& signature) {
+    const TableData& table = tables[signature];
+    for (uint8_t kind = 0; kind < 2; ++kind) {
+        TablebaseHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "CTB1", 4);
+        header.kind = kind;
+        header.pieceCount = static_cast<uint8_t>(table.pieces.length());
+        memcpy(header.pieces, table.pieces.data(), table.pieces.length());
+
+        std::vector<uint8_t> data;
+        if (kind == 0) {
+            // Four 2-bit values per byte
+            data.assign((table.size + 3) / 4, 0);
+            for (uint64_t index = 0; index < table.size; ++index) {
+                data[index >> 2] |= static_cast<uint8_t>(table.value[index] << ((index & 3) * 2));
+            }
+        } else {
+            data = table.dtm;
+        }
+
+        std::string path = directory + "/" + signature + (kind == 0 ? ".wdl" : ".dtm");
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cout << "Error: Could not open file " << path << " for writing.\n";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string directory;
+    std::vector<std::string> signatures;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::max(1, std::stoi(argv[++i]));
+        } else if (directory.empty()) {
+            directory = arg;
+        } else {
+            signatures.push_back(arg);
+        }
+    }
+    if (directory.empty()) {
+        std::cout << "Usage: tbgen <output-dir> [signature ...] [--threads N]\n";
+        return 1;
+    }
+    if (signatures.empty()) {
+        signatures = {"KQvK", "KRvK", "KPvK", "KBNvK"};
+    }
+
+    for (const auto& requested : signatures) {
+        if (requested.find('v') == std::string::npos || requested[0] != 'K' ||
+            requested.length() - 1 > static_cast<size_t>(MAX_PIECES)) {
+            std::cout << "Skipping " << requested << ": expected a signature like KQvK with at most "
+                      << MAX_PIECES << " pieces\n";
+            continue;
+        }
+        generate(canonicalSignature(requested));
+    }
+
+    // Every table generated, dependencies included, is written so the engine can probe it
+    size_t bytes = 0;
+    for (const auto& item : tables) {
+        if (!writeTable(directory, item.first)) return 1;
+        bytes += sizeof(TablebaseHeader) * 2 + (item.second.size + 3) / 4 + item.second.size;
+    }
+    std::cout << "Wrote " << tables.size() << " tables (" << bytes / 1024 << " KB) to " << directory << "\n";
+    return 0;
+}